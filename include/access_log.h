@@ -0,0 +1,56 @@
+/*
+Description: Access event log. Every scan result is recorded (sequence number, uptime, ID, confidence, result code)
+in a RAM ring, which costs a copy on the LVGL thread and never touches flash. On the device a low-priority writer
+task (access_log_poll() in the host loop) writes the ring to SPIFFS in batches, appended to a set of fixed-size segment files that are reused round robin, so the
+log takes a bounded amount of flash and every byte is written once per rotation. Each record carries a CRC, so a
+record torn by a power loss is skipped at boot instead of corrupting the log.
+*/
+
+#ifndef ACCESS_LOG_H
+#define ACCESS_LOG_H
+
+#include <stdint.h>
+
+#ifndef ACCESS_LOG_PREFIX
+#define ACCESS_LOG_PREFIX "/access"      // Segment files are /access0.log, /access1.log, ...
+#endif
+#ifndef ACCESS_LOG_SEGMENTS
+#define ACCESS_LOG_SEGMENTS 4            // Segments kept; the oldest is overwritten when the last one is full
+#endif
+#ifndef ACCESS_LOG_SEGMENT_RECORDS
+#define ACCESS_LOG_SEGMENT_RECORDS 1024  // Records per segment (16 KB)
+#endif
+#ifndef ACCESS_LOG_RING
+#define ACCESS_LOG_RING 64               // Records buffered in RAM
+#endif
+#ifndef ACCESS_LOG_BATCH
+#define ACCESS_LOG_BATCH 16              // Records per flash write (one 256-byte SPIFFS page)
+#endif
+#ifndef ACCESS_LOG_FLUSH_MS
+#define ACCESS_LOG_FLUSH_MS 60000        // Longest time a record waits in RAM
+#endif
+#define ACCESS_LOG_DRAIN_MS 250          // Writer task wake-up interval
+#define ACCESS_LOG_CORE 0                // Writer task core
+#define ACCESS_LOG_PRIORITY 1            // Below the fingerprint service, so it never delays a scan
+#define ACCESS_LOG_STACK 4096            // Bytes of stack for the writer task (SPIFFS calls)
+
+// One access event, 16 bytes on flash
+struct access_record_t {
+  uint32_t seq;         // Sequence number, continues across reboots
+  uint32_t uptime;      // millis() when the result arrived
+  uint16_t id;          // Matched ID (0 if none)
+  uint16_t confidence;  // Match confidence (0 if none)
+  uint8_t code;         // Sensor status code of the scan
+  uint8_t boot;         // Boot number (wraps), tells uptimes of different boots apart
+};
+
+bool access_log_begin();                           // Mount, find the newest segment, start the writer task
+void access_log_add(uint8_t code, uint16_t id, uint16_t confidence); // Record a scan result (RAM only)
+void access_log_poll();                            // Write a batch when one is due (writer task, host loop)
+bool access_log_flush();                           // Write everything buffered now
+void access_log_set_quiet(bool quiet);             // While set, no segment is erased (scanning, enrolling)
+uint16_t access_log_pending();                     // Records waiting in RAM
+uint32_t access_log_dropped();                     // Records lost because the ring was full
+uint16_t access_log_recent(access_record_t *out, uint16_t max); // Newest records first, flash and RAM
+
+#endif // ACCESS_LOG_H
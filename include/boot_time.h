@@ -0,0 +1,25 @@
+/*
+Description: Boot-phase profiler. setup() marks the end of each boot phase; boot_report() logs every phase with its
+duration and the time since the application started, so changes to the boot order can be compared on the device.
+Times come from micros(), which on the ESP32 starts with the application: ROM and second-stage bootloader time
+(a few hundred ms) is not included.
+*/
+
+#ifndef BOOT_TIME_H
+#define BOOT_TIME_H
+
+#include <stdint.h>
+
+#define BOOT_PHASES_MAX 12  // Phases recorded; later marks are ignored
+
+struct boot_phase_t {
+  const char *name;  // Phase that ended here (string literal)
+  uint32_t us;       // micros() at its end
+};
+
+void boot_phase(const char *name);            // Mark the end of a phase
+uint8_t boot_phase_count();                   // Phases marked so far
+const boot_phase_t *boot_phase_at(uint8_t i); // Phase i in order, NULL past the end
+void boot_report();                           // Log all phases at INFO level
+
+#endif // BOOT_TIME_H
@@ -0,0 +1,14 @@
+/*
+Description: CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) used by the records the firmware keeps in
+flash and NVS to detect torn or corrupted writes.
+*/
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+uint16_t crc16_ccitt(const uint8_t *data, size_t len);  // CRC of len bytes
+
+#endif // CRC16_H
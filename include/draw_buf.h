@@ -0,0 +1,52 @@
+/*
+Description: LVGL draw buffers of the display. LVGL renders a refresh in stripes of the buffer's height and flushes
+each stripe, so taller buffers mean fewer flush calls per refresh at the cost of RAM. The height is chosen at build
+time with DRAW_BUF_LINES and can be changed at runtime. Partial buffers are taken from DMA-capable internal RAM. The
+full frame, and a buffer internal RAM cannot hold, goes to PSRAM as a single buffer: the ESP32's SPI DMA cannot
+read PSRAM, so the flush callback sends those stripes without DMA and a second buffer would never be rendered into.
+In auto-tune mode boot times full-screen refreshes with several heights that fit in internal RAM and keeps the
+fastest.
+*/
+
+#ifndef DRAW_BUF_H
+#define DRAW_BUF_H
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// Special values of DRAW_BUF_LINES; positive values are lines
+#define DRAW_BUF_AUTO 0      // Auto-tune at boot
+#define DRAW_BUF_QUARTER -4  // 1/4 of the screen height
+#define DRAW_BUF_HALF -2     // 1/2 of the screen height
+#define DRAW_BUF_FULL -1     // Whole frame, in PSRAM
+
+#ifndef DRAW_BUF_LINES
+#define DRAW_BUF_LINES 10  // Height of the buffers (two in internal RAM, one in PSRAM)
+#endif
+
+#define DRAW_BUF_FALLBACK_LINES 10  // Before auto-tuning, and if the configured buffers cannot be allocated
+
+#ifndef DRAW_BUF_RESERVE
+#define DRAW_BUF_RESERVE (48U * 1024U)  // Internal RAM the auto-tune leaves to the rest of the firmware
+#endif
+
+#define DRAW_BUF_TUNE_MAX 6        // Heights tried by the auto-tune
+#define DRAW_BUF_TUNE_REFRESHES 3  // Full refreshes timed per height
+#define DRAW_BUF_TUNE_TIE_PCT 3    // A smaller buffer this close to the fastest wins (saves RAM)
+
+// One height tried by the auto-tune
+struct draw_buf_trial_t {
+  uint16_t lines;  // Buffer height
+  uint32_t us;     // Average full-screen refresh, until the last stripe was sent
+  bool fits;       // Both buffers fit in internal RAM with DRAW_BUF_RESERVE left
+};
+
+uint16_t draw_buf_resolve(int16_t option, uint16_t height);             // Lines for a DRAW_BUF_LINES value, 0 for auto
+uint8_t draw_buf_pick(const draw_buf_trial_t *trials, uint8_t count);   // Index of the winner, count if none fits
+bool draw_buf_begin(lv_disp_draw_buf_t *drawBuf, uint16_t width, uint16_t height, int16_t option); // Before registering
+bool draw_buf_set_lines(lv_disp_t *disp, int16_t option);  // As DRAW_BUF_LINES, between refreshes; redraws the screen
+uint16_t draw_buf_lines();                                 // Current height
+bool draw_buf_in_psram();                                  // Buffers in PSRAM: flush without DMA
+uint16_t draw_buf_autotune(lv_disp_t *disp);               // Time the candidates, keep and return the fastest
+
+#endif // DRAW_BUF_H
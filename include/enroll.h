@@ -0,0 +1,47 @@
+/*
+Description: Non-blocking fingerprint enrollment. Enrollment is an explicit state machine that performs at most one
+sensor command per call. It runs on the fingerprint service task and reports every state change through a
+listener, so the LVGL thread only applies the resulting messages and stays responsive for the whole enrollment.
+*/
+
+#ifndef ENROLL_H
+#define ENROLL_H
+
+#include <stdint.h>
+
+#ifndef ENROLL_POLL_MS
+#define ENROLL_POLL_MS 100            // Interval between getImage() polls while waiting for the finger
+#endif
+#ifndef ENROLL_FINGER_TIMEOUT_MS
+#define ENROLL_FINGER_TIMEOUT_MS 15000 // Give up if no finger is placed (or removed) within this time
+#endif
+#ifndef ENROLL_RESULT_MS
+#define ENROLL_RESULT_MS 2000         // How long a success or error message stays on screen
+#endif
+
+// Enrollment states, in the order they normally run
+enum enroll_state_t {
+  ENROLL_IDLE = 0,        // Not enrolling
+  ENROLL_WAIT_FIRST,      // Waiting for the first finger placement
+  ENROLL_CONVERT_FIRST,   // Converting the first image to template slot 1
+  ENROLL_WAIT_REMOVE,     // Waiting for the finger to be lifted
+  ENROLL_WAIT_SECOND,     // Waiting for the second finger placement
+  ENROLL_CONVERT_SECOND,  // Converting the second image to template slot 2
+  ENROLL_CREATE_MODEL,    // Merging the two templates
+  ENROLL_STORE,           // Storing the model under the requested ID
+  ENROLL_DONE,            // Showing the success message, then back to idle
+  ENROLL_FAILED,          // Showing an error message, then retrying from the first placement
+  ENROLL_TIMED_OUT        // Showing the timeout message, then back to idle
+};
+
+// Called on every state change: new state, state that was left, and the sensor status code of the last command
+typedef void (*enroll_listener_t)(enroll_state_t state, enroll_state_t from, uint8_t code);
+
+void enroll_set_listener(enroll_listener_t listener); // Receive state changes
+bool enroll_start(uint16_t enrollId);  // Start enrolling under enrollId; false (and FAILED from IDLE) if it is taken
+bool handleFingerprintEnrollment();   // Advance by at most one sensor command; false once idle
+void enroll_cancel();                 // Abort a running enrollment without reporting
+enroll_state_t enroll_state();        // Current state
+const char *enroll_state_name(enroll_state_t state); // State name for logging
+
+#endif // ENROLL_H
@@ -0,0 +1,28 @@
+/*
+Description: Finger presence detection through the sensor's touch/wake output (R503 WAKEUP, R30x TOUCH) on a GPIO
+interrupt. When the line is wired, scanning and enrollment only talk to the sensor while a finger is actually on
+it; when it is not (FINGER_TOUCH_PIN < 0) every query reports "maybe present" and callers keep polling getImage().
+*/
+
+#ifndef FINGER_DETECT_H
+#define FINGER_DETECT_H
+
+#include <stdint.h>
+
+#ifndef FINGER_TOUCH_PIN
+#define FINGER_TOUCH_PIN -1            // GPIO of the touch/wake output, -1 if not wired (polling fallback)
+#endif
+#ifndef FINGER_TOUCH_ACTIVE_LEVEL
+#define FINGER_TOUCH_ACTIVE_LEVEL HIGH // Level of the line while a finger is on the sensor
+#endif
+#ifndef FINGER_TOUCH_WAIT_MS
+#define FINGER_TOUCH_WAIT_MS 200       // Longest a scan command waits for a touch before reporting no finger
+#endif
+
+bool finger_detect_begin(int8_t pin);      // Attach the interrupt; false if the line is not wired
+bool finger_detect_wired();                // True if a touch line is in use
+bool finger_detect_present();              // Finger on the sensor (always true without a touch line)
+bool finger_detect_wait(uint32_t timeoutMs); // Block until a finger touches or the timeout expires
+uint32_t finger_detect_touch_count();      // Number of touch interrupts since boot
+
+#endif // FINGER_DETECT_H
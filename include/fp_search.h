@@ -0,0 +1,37 @@
+/*
+Description: 1:N search strategies for getFingerprintID(). The module's plain search walks every page of the
+library, so the time for an unknown finger grows with the sensor's capacity rather than with the number of
+enrolled users. The high-speed search command is several times cheaper per page, and the occupied-range strategy
+only searches the page ranges that hold templates, taken from the template slot cache (fp_slots.h).
+*/
+
+#ifndef FP_SEARCH_H
+#define FP_SEARCH_H
+
+#include <stdint.h>
+
+#ifndef FP_SEARCH_MAX_RANGES
+#define FP_SEARCH_MAX_RANGES 8       // Search commands per scan at most
+#endif
+#ifndef FP_SEARCH_MERGE_GAP
+#define FP_SEARCH_MERGE_GAP 64       // Empty pages cheaper to search through than another command round trip
+#endif
+
+// How getFingerprintID() searches the library
+enum fp_search_mode_t {
+  FP_SEARCH_FULL = 0,   // Plain search over the whole library (finger.fingerSearch())
+  FP_SEARCH_FAST,       // High-speed search over the whole library
+  FP_SEARCH_OCCUPIED    // High-speed search over the occupied page ranges only
+};
+
+#ifndef FP_SEARCH_MODE
+#define FP_SEARCH_MODE FP_SEARCH_OCCUPIED  // Strategy after boot
+#endif
+
+void fp_search_set_mode(fp_search_mode_t mode);  // Change the strategy at runtime
+fp_search_mode_t fp_search_mode();               // Current strategy
+const char *fp_search_mode_name(fp_search_mode_t mode); // Strategy name for logging
+uint8_t fp_search();                             // Search char buffer 1; sets finger.fingerID/confidence like fingerSearch()
+uint8_t fp_search_range_count();                 // Number of search commands an unknown finger costs right now
+
+#endif // FP_SEARCH_H
@@ -0,0 +1,81 @@
+/*
+Description: Fingerprint service. All sensor traffic runs on a dedicated FreeRTOS task pinned to the other ESP32
+core; the LVGL thread sends commands through a queue and applies the typed results it gets back, so UART round
+trips to the sensor never stall rendering or touch input.
+*/
+
+#ifndef FP_SERVICE_H
+#define FP_SERVICE_H
+
+#include <stdint.h>
+
+#ifndef FP_SERVICE_CORE
+#define FP_SERVICE_CORE 0           // Arduino loop() and LVGL run on core 1
+#endif
+#ifndef FP_SERVICE_PRIORITY
+#define FP_SERVICE_PRIORITY 2       // Above loopTask (1) so results arrive promptly
+#endif
+#ifndef FP_SERVICE_STACK
+#define FP_SERVICE_STACK 4096       // Bytes of stack for the service task
+#endif
+#define FP_SERVICE_STEP_MS 10       // Task wake-up interval while an enrollment is running
+#define FP_COMMAND_QUEUE_LENGTH 4   // Pending commands
+#define FP_RESULT_QUEUE_LENGTH 8    // Results waiting for the LVGL thread
+
+// Commands understood by the service
+enum fp_command_type_t {
+  FP_CMD_SCAN = 0,    // One getImage/image2Tz/search cycle
+  FP_CMD_ENROLL,      // Start enrolling under id (runs until done, failed for good or cancelled)
+  FP_CMD_CANCEL,      // Cancel a running enrollment
+  FP_CMD_DELETE,      // Delete the template stored under id
+  FP_CMD_COUNT        // Read the number of stored templates
+};
+
+struct fp_command_t {
+  fp_command_type_t type;  // What to do
+  uint16_t id;             // Template ID for FP_CMD_ENROLL / FP_CMD_DELETE
+};
+
+// Results posted back to the LVGL thread
+enum fp_result_type_t {
+  FP_RES_SCAN = 0,    // code, id and confidence of a scan
+  FP_RES_ENROLL,      // Enrollment state change (state, from, code)
+  FP_RES_DELETE,      // code and id of a delete
+  FP_RES_COUNT,       // code and count of a template count
+  FP_RES_READY        // code of the sensor handshake run by the task (FINGERPRINT_OK: commands are served)
+};
+
+struct fp_result_t {
+  fp_result_type_t type;  // Which command produced this result
+  uint8_t code;           // Sensor status code (FINGERPRINT_OK, FINGERPRINT_NOFINGER, ...)
+  uint8_t state;          // FP_RES_ENROLL: new enroll_state_t
+  uint8_t from;           // FP_RES_ENROLL: enroll_state_t that was left
+  uint16_t id;            // Matched, enrolled or deleted template ID
+  uint16_t confidence;    // FP_RES_SCAN: match confidence
+  uint16_t count;         // FP_RES_COUNT: number of stored templates
+};
+
+uint8_t getFingerprintID(uint16_t *fingerprintId);      // One getImage/image2Tz/search cycle (service side);
+                                                         // sensor status code, matched ID when FINGERPRINT_OK
+uint8_t fp_command(uint8_t *data, uint16_t len, uint8_t *reply, uint16_t replyLen); // Raw command packet for
+                                                         // instructions Adafruit_Fingerprint lacks; confirmation code
+
+// Sensor handshake as seen by the LVGL thread
+enum fp_sensor_state_t {
+  FP_SENSOR_READY = 0,   // Handshake done (or run by the caller before fp_service_begin)
+  FP_SENSOR_CONNECTING,  // Service task is still running the handshake
+  FP_SENSOR_MISSING      // Handshake failed, no commands are served
+};
+
+typedef bool (*fp_connect_t)();                          // Sensor handshake; false if the sensor did not answer
+
+bool fp_service_begin(fp_connect_t connect = NULL);      // Create the queues and start the service task, which
+                                                         // runs connect first and posts FP_RES_READY
+bool fp_service_send(fp_command_type_t type, uint16_t id = 0); // Queue a command without blocking
+uint16_t fp_capacity();                                  // Library size reported by the sensor (IDs 0..capacity-1)
+bool fp_service_receive(fp_result_t *result);            // Fetch the next result without blocking
+fp_sensor_state_t fp_sensor_state();                     // Handshake state as of the last result fetched
+
+void fingerprint_poll();  // LVGL thread: send commands for the active mode and apply results (src/fp_ui.cpp)
+
+#endif // FP_SERVICE_H
@@ -0,0 +1,32 @@
+/*
+Description: In-RAM cache of the sensor's template slots. The occupancy bitmap is read once from the module's index
+table at boot and then updated by every store and delete, so the firmware never has to ask the sensor which IDs
+are taken: enrollment gets the next free ID in O(1) and refuses IDs that already hold a template.
+*/
+
+#ifndef FP_SLOTS_H
+#define FP_SLOTS_H
+
+#include <stdint.h>
+
+#ifndef FINGERPRINT_READINDEX
+#define FINGERPRINT_READINDEX 0x1F   // Read one page of the template index table (not in Adafruit_Fingerprint)
+#endif
+
+#ifndef FP_SLOTS_MAX
+#define FP_SLOTS_MAX 1024            // Largest library tracked in the bitmap (4 index pages)
+#endif
+#define FP_SLOTS_INDEX_PAGE 256      // Templates covered by one index table page
+#define FP_SLOTS_FIRST_ID 1          // Lowest ID offered for enrollment
+#define FP_SLOT_NONE 0xFFFF          // No free slot
+
+uint8_t fp_slots_begin();                 // Read the index table (after getParameters()); sensor status code
+bool fp_slots_valid();                    // True once the bitmap was read from the module
+uint16_t fp_slots_capacity();             // IDs covered by the bitmap, the only ones offered for enrollment
+bool fp_slots_occupied(uint16_t id);      // True if id holds a template
+void fp_slots_mark(uint16_t id, bool occupied); // Record a store or delete (fingerprint service task)
+uint16_t fp_slots_next_free();            // Lowest free ID >= FP_SLOTS_FIRST_ID, FP_SLOT_NONE if full
+uint16_t fp_slots_count();                // Number of stored templates
+uint32_t fp_slots_version();              // Changes whenever the bitmap changes
+
+#endif // FP_SLOTS_H
@@ -0,0 +1,23 @@
+/*
+Description: Numeric keypad for entering a template ID, built on lv_btnmatrix: twelve large keys (digits, backspace
+and OK) over the lower half of the screen and a label showing the typed ID. Digits that would take the ID past the
+sensor's capacity are refused as they are typed, so only an empty entry can be out of range. A keypress redraws the
+key and the label, not the whole widget. OK sends LV_EVENT_READY to the keypad object.
+*/
+
+#ifndef ID_KEYPAD_H
+#define ID_KEYPAD_H
+
+#include <stdint.h>
+#include <lvgl.h>
+
+#define ID_KEYPAD_BACKSPACE 9  // Button index of the backspace key
+#define ID_KEYPAD_OK 11        // Button index of the OK key
+
+lv_obj_t *id_keypad_create(lv_obj_t *parent);          // Keypad and value label on parent (one keypad per UI)
+void id_keypad_set_range(uint16_t minId, uint16_t maxId); // IDs that can be entered
+void id_keypad_set_value(uint16_t value);               // Preset the entry (0: empty); refused if above the range
+uint16_t id_keypad_get_value();                         // Typed ID, 0 while empty
+uint16_t id_keypad_apply(uint16_t value, uint16_t key, uint16_t maxId); // Value after a digit or backspace key
+
+#endif // ID_KEYPAD_H
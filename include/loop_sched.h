@@ -0,0 +1,27 @@
+/*
+Description: Main loop scheduler. Instead of a fixed delay(5), loop() sleeps until the next LVGL timer is due (the
+value lv_timer_handler() returns) and is woken early by a fingerprint result or, if the touch controller's PENIRQ
+line is wired, by a touch, which is then read at once instead of at the next input poll. When the main menu has
+been left untouched for LOOP_IDLE_SLEEP_MS the ESP32 goes into light sleep between touches.
+*/
+
+#ifndef LOOP_SCHED_H
+#define LOOP_SCHED_H
+
+#include <stdint.h>
+#include "touch_irq.h"
+
+#define LOOP_MIN_WAIT_MS 1            // Shortest wait (one FreeRTOS tick)
+#define LOOP_MAX_WAIT_MS 30           // Longest wait while awake (LVGL's input read period)
+#ifndef LOOP_IDLE_SLEEP_MS
+#define LOOP_IDLE_SLEEP_MS 10000      // Main menu untouched this long: light sleep (needs TOUCH_IRQ_PIN)
+#endif
+#define LOOP_LIGHT_SLEEP_MS 1000      // Longest light sleep; a touch wakes earlier
+
+bool loop_sched_begin(int8_t touchIrqPin);  // Light sleep until PENIRQ if wired (call from setup())
+uint32_t loop_sched_plan(uint32_t lvglWaitMs, bool menuIdle, uint32_t inactiveMs, bool *lightSleep); // Wait in ms
+bool loop_sched_sleep(uint32_t ms, bool lightSleep);  // Wait or light sleep; true if a touch ended it
+void loop_sched_wake();                               // Wake loop() now (other tasks)
+void loop_sched_touch_from_isr();                     // Wake loop() for a touch (PENIRQ interrupt)
+
+#endif // LOOP_SCHED_H
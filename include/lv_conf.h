@@ -0,0 +1,74 @@
+/*
+ * LVGL configuration for the fingerprint terminal.
+ *
+ * Only the options that differ from LVGL's defaults are set here; everything else
+ * falls back to lv_conf_internal.h. Picked up through -D LV_CONF_INCLUDE_SIMPLE in platformio.ini.
+ */
+
+#if 1 /* Set this to "1" to enable content */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#include <stdint.h>
+
+/*====================
+   COLOR SETTINGS
+ *====================*/
+
+/* 16 bit RGB565 to match the ILI9341 panel */
+#define LV_COLOR_DEPTH 16
+
+/* Render directly in the panel's (big-endian) byte order so the flush callback can ship
+ * the buffer untouched. Enabled per build with -D LV_COLOR_16_SWAP=1. */
+#ifndef LV_COLOR_16_SWAP
+#define LV_COLOR_16_SWAP 0
+#endif
+
+/*=========================
+   MEMORY SETTINGS
+ *=========================*/
+
+/* Backend of lv_mem_alloc(), chosen per build with -D LV_MEM_BACKEND=<name> (src/lv_mem_port.cpp):
+ * POOL  LVGL's own TLSF pool, a static array in internal RAM (default)
+ * HEAP  the ESP-IDF heap (malloc/free), shared with the rest of the firmware
+ * PSRAM LVGL's TLSF pool allocated in PSRAM at lv_init(), in internal RAM on boards without PSRAM */
+#define LV_MEM_BACKEND_POOL 0
+#define LV_MEM_BACKEND_HEAP 1
+#define LV_MEM_BACKEND_PSRAM 2
+#ifndef LV_MEM_BACKEND
+#define LV_MEM_BACKEND LV_MEM_BACKEND_POOL
+#endif
+
+#if LV_MEM_BACKEND == LV_MEM_BACKEND_HEAP
+#define LV_MEM_CUSTOM 1
+#define LV_MEM_CUSTOM_INCLUDE "lv_mem_port.h"
+#define LV_MEM_CUSTOM_ALLOC lv_mem_port_malloc    /* Counts LVGL's bytes for the memory monitor */
+#define LV_MEM_CUSTOM_FREE lv_mem_port_free
+#define LV_MEM_CUSTOM_REALLOC lv_mem_port_realloc
+#else
+#define LV_MEM_CUSTOM 0
+#if LV_MEM_BACKEND == LV_MEM_BACKEND_PSRAM
+#define LV_MEM_POOL_INCLUDE "lv_mem_port.h"
+#define LV_MEM_POOL_ALLOC lv_mem_port_pool_alloc  /* Called once with LV_MEM_SIZE */
+#endif
+#endif
+
+/* Size of the memory available for lv_mem_alloc() in bytes (>= 2kB), pool backends only.
+ * With PSRAM it can be raised with -D LV_MEM_SIZE=... */
+#ifndef LV_MEM_SIZE
+#define LV_MEM_SIZE (48U * 1024U)
+#endif
+
+/*====================
+   HAL SETTINGS
+ *====================*/
+
+/* Use Arduino's millis() as the LVGL tick source instead of calling lv_tick_inc() */
+#define LV_TICK_CUSTOM 1
+#define LV_TICK_CUSTOM_INCLUDE "Arduino.h"
+#define LV_TICK_CUSTOM_SYS_TIME_EXPR (millis())
+
+#endif /*LV_CONF_H*/
+
+#endif /*End of "Content enable"*/
@@ -0,0 +1,34 @@
+/*
+Description: Backends of LVGL's heap, selected with LV_MEM_BACKEND in lv_conf.h. The heap backend hands LVGL's
+allocations to malloc() and counts the bytes LVGL holds, since lv_mem_monitor() sees nothing once LVGL stops using
+its own pool. The PSRAM backend provides the storage of LVGL's TLSF pool, taken from PSRAM when the board has it.
+Included by LVGL's C sources through lv_conf.h, so the interface is plain C.
+*/
+
+#ifndef LV_MEM_PORT_H
+#define LV_MEM_PORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LV_MEM_BACKEND_HEAP: LV_MEM_CUSTOM_ALLOC/FREE/REALLOC
+void *lv_mem_port_malloc(size_t size);
+void lv_mem_port_free(void *p);
+void *lv_mem_port_realloc(void *p, size_t size);
+uint32_t lv_mem_port_used(void);      // Bytes LVGL currently holds from the heap
+uint32_t lv_mem_port_max_used(void);  // Peak of lv_mem_port_used() since boot
+
+// LV_MEM_BACKEND_PSRAM: LV_MEM_POOL_ALLOC, called once by lv_init()
+void *lv_mem_port_pool_alloc(size_t size);
+bool lv_mem_port_pool_in_psram(void); // False if the pool had to go to internal RAM
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LV_MEM_PORT_H
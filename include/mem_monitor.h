@@ -0,0 +1,39 @@
+/*
+Description: LVGL heap monitor. Reads used, peak, free and largest free block of whichever backend LV_MEM_BACKEND
+selected (lv_conf.h) and reports them periodically on Serial and, optionally, in a small overlay on LVGL's system
+layer that stays on top of every screen. Fragmentation is the share of free memory outside the largest free block:
+at 0% any allocation up to the free total succeeds, at 50% the biggest one that fits is half of it.
+*/
+
+#ifndef MEM_MONITOR_H
+#define MEM_MONITOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef MEM_MONITOR_PERIOD_MS
+#define MEM_MONITOR_PERIOD_MS 5000  // Report interval
+#endif
+
+#ifndef MEM_MONITOR_OVERLAY
+#define MEM_MONITOR_OVERLAY 0  // 1: also show the figures on screen
+#endif
+
+// One reading of LVGL's heap
+struct mem_stats_t {
+  uint32_t total;        // Bytes the backend can hand out (heap backend: free plus allocated, whole firmware)
+  uint32_t used;         // Bytes LVGL holds
+  uint32_t maxUsed;      // Peak of used since boot
+  uint32_t freeBytes;    // Free bytes (heap backend: whole firmware; 0 if unknown, as on the host)
+  uint32_t largestFree;  // Largest free block: the biggest allocation that can still succeed
+  uint8_t fragPct;       // Fragmentation in percent
+};
+
+uint8_t mem_frag_pct(uint32_t freeBytes, uint32_t largestFree);     // 100 - largest * 100 / free, 0 if nothing free
+void mem_stats_read(mem_stats_t *stats);                            // Current figures of the active backend
+const char *mem_backend_name();                                     // "pool", "heap", "psram" or "psram (internal)"
+size_t mem_stats_format(const mem_stats_t *stats, char *buf, size_t len);  // One line, like snprintf()
+void mem_monitor_begin(bool overlay);  // Report every MEM_MONITOR_PERIOD_MS from an LVGL timer (after lv_init())
+void mem_monitor_report();             // Log the current figures once (and update the overlay)
+
+#endif // MEM_MONITOR_H
@@ -0,0 +1,20 @@
+/*
+Description: UART link to the fingerprint sensor. Finds the baud rate the sensor is currently configured for,
+raises it to SENSOR_TARGET_BAUD through the system-parameter write command and falls back to the old rate if the
+sensor does not answer at the new one. The handshake only succeeds if the sensor then reports its parameters.
+*/
+
+#ifndef SENSOR_LINK_H
+#define SENSOR_LINK_H
+
+#include <stdint.h>
+
+#ifndef SENSOR_TARGET_BAUD
+#define SENSOR_TARGET_BAUD 115200  // Highest rate of the R30x/R503 protocol (N = 12, 12 x 9600)
+#endif
+#define SENSOR_DEFAULT_BAUD 57600  // Factory setting of the module
+
+uint32_t sensor_link_open(int8_t rxPin, int8_t txPin); // Open mySerial, raise the rate, read the parameters; 0 on failure
+void sensor_link_profile(uint16_t cycles);            // Print the time of a getImage+image2Tz+fingerSearch cycle
+
+#endif // SENSOR_LINK_H
@@ -0,0 +1,53 @@
+/*
+Description: Leveled, non-blocking debug output. LOG_E/LOG_W/LOG_I/LOG_D format the line into a slot of a lock-free
+ring and return; a low-priority task writes the ring to Serial, so a full UART FIFO only ever delays that task and
+never a scan, an enrollment step or the LVGL loop. The writer drops consecutive repeats of a line (reporting how many)
+and limits the output to SERIAL_LOG_RATE lines per second. Lines above SERIAL_LOG_LEVEL are compiled out; the level
+can be lowered further at runtime.
+*/
+
+#ifndef SERIAL_LOG_H
+#define SERIAL_LOG_H
+
+#include <stdint.h>
+
+#define SERIAL_LOG_NONE 0
+#define SERIAL_LOG_ERROR 1
+#define SERIAL_LOG_WARN 2
+#define SERIAL_LOG_INFO 3
+#define SERIAL_LOG_DEBUG 4
+
+#ifndef SERIAL_LOG_LEVEL
+#define SERIAL_LOG_LEVEL SERIAL_LOG_INFO  // Most verbose level compiled in
+#endif
+#ifndef SERIAL_LOG_SLOTS
+#define SERIAL_LOG_SLOTS 32               // Lines buffered (power of two)
+#endif
+#define SERIAL_LOG_LINE_MAX 96            // Longest line in bytes, longer ones are cut
+#ifndef SERIAL_LOG_RATE
+#define SERIAL_LOG_RATE 20                // Lines per second written at most (also the burst size)
+#endif
+#define SERIAL_LOG_REPEAT_MS 1000         // A run of repeated lines is reported at least this often
+#define SERIAL_LOG_DRAIN_MS 20            // Writer task wake-up interval
+#define SERIAL_LOG_CORE 0                 // Writer task core
+#define SERIAL_LOG_PRIORITY 1             // Below the fingerprint service, so it never delays a scan
+#define SERIAL_LOG_STACK 3072             // Bytes of stack for the writer task
+
+#define SERIAL_LOG_AT(level, ...) \
+  do { if ((level) <= SERIAL_LOG_LEVEL) serial_log_write((level), __VA_ARGS__); } while (0)
+#define LOG_E(...) SERIAL_LOG_AT(SERIAL_LOG_ERROR, __VA_ARGS__)  // Something failed
+#define LOG_W(...) SERIAL_LOG_AT(SERIAL_LOG_WARN, __VA_ARGS__)   // Something unusual, the firmware carries on
+#define LOG_I(...) SERIAL_LOG_AT(SERIAL_LOG_INFO, __VA_ARGS__)   // Results and state changes
+#define LOG_D(...) SERIAL_LOG_AT(SERIAL_LOG_DEBUG, __VA_ARGS__)  // Button presses, polling results
+
+typedef void (*serial_log_sink_t)(uint8_t level, const char *line);  // Receives each line written
+
+bool serial_log_begin();                        // Start the writer task (lines logged earlier are kept)
+void serial_log_set_level(uint8_t level);       // Most verbose level written from now on
+uint8_t serial_log_level();                     // Current runtime level
+void serial_log_write(uint8_t level, const char *fmt, ...) __attribute__((format(printf, 2, 3))); // Queue one line
+void serial_log_drain();                        // Write the queued lines (writer task; host main loop)
+void serial_log_set_sink(serial_log_sink_t sink); // Send lines somewhere else than Serial (NULL restores it)
+uint32_t serial_log_dropped();                  // Lines lost to a full ring or to the rate limit
+
+#endif // SERIAL_LOG_H
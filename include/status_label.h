@@ -0,0 +1,39 @@
+/*
+Description: Status message component wrapping fingerLabel. Updates the label only when the message actually
+changes, so repeating the same status every loop iteration does not invalidate the label or push pixels over SPI.
+*/
+
+#ifndef STATUS_LABEL_H
+#define STATUS_LABEL_H
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// Fixed status messages, compared by id instead of by string
+enum status_msg_t {
+  STATUS_TEXT = 0,        // Free text set through status_set() / status_set_fmt()
+  STATUS_SELECT,          // "Select Enroll or Scan."
+  STATUS_SCANNING,        // "Scanning..."
+  STATUS_RETURNING,       // "Returning to main menu..."
+  STATUS_ENTER_ID,        // "Enrolling, please enter the ID:"
+  STATUS_NO_FINGER,       // "No Finger Detected"
+  STATUS_NO_MATCH,        // "No Match Found"
+  STATUS_LIBRARY_FULL,    // "Fingerprint library is full."
+  STATUS_READ_ERROR,      // "Finger not read, please try again."
+  STATUS_CONNECTING,      // "Connecting to the sensor..."
+  STATUS_NO_SENSOR,       // "Fingerprint sensor not found."
+  STATUS_MSG_COUNT
+};
+
+void status_init(lv_obj_t *label);                  // Attach the component to the status label
+bool status_show(status_msg_t msg);                 // Show a fixed message; false if it was already shown
+bool status_set(const char *text);                  // Show free text; false if the label already shows it
+bool status_set_fmt(const char *fmt, ...)           // printf-style status_set()
+    __attribute__((format(printf, 1, 2)));
+const char *status_text(status_msg_t msg);          // Text of a fixed message
+
+uint32_t status_update_count();                     // Updates that changed the label
+uint32_t status_skip_count();                       // Updates skipped because nothing changed
+void status_reset_counters();                       // Start counting from zero
+
+#endif // STATUS_LABEL_H
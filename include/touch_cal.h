@@ -0,0 +1,25 @@
+/*
+Description: Touch calibration store. The five TFT_eSPI calibration values are kept in NVS as one small record
+with a version, the display rotation they were taken at and a CRC, so booting reads a few bytes from NVS instead of
+mounting SPIFFS, and a corrupted record or a changed rotation leads to a new calibration instead of a wrong one.
+*/
+
+#ifndef TOUCH_CAL_H
+#define TOUCH_CAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TOUCH_CAL_NAMESPACE "touch"             // NVS namespace
+#define TOUCH_CAL_KEY "cal"                     // NVS key of the record
+#define TOUCH_CAL_VERSION 1                     // Record layout version
+#define TOUCH_CAL_VALUES 5                      // uint16_t values of TFT_eSPI::setTouch()
+#define TOUCH_CAL_RECORD_SIZE 16                // 'T','C', version, rotation, 5 x uint16 LE, CRC16 LE
+#define TOUCH_CAL_LEGACY_FILE "/TouchCalData3"  // SPIFFS file of older firmware, migrated once
+
+size_t touch_cal_encode(const uint16_t cal[TOUCH_CAL_VALUES], uint8_t rotation, uint8_t *record);
+bool touch_cal_decode(const uint8_t *record, size_t len, uint8_t rotation, uint16_t cal[TOUCH_CAL_VALUES]);
+bool touch_cal_load(uint8_t rotation, uint16_t cal[TOUCH_CAL_VALUES]);        // Valid record for this rotation
+bool touch_cal_save(const uint16_t cal[TOUCH_CAL_VALUES], uint8_t rotation);  // Write the record to NVS
+
+#endif // TOUCH_CAL_H
@@ -0,0 +1,53 @@
+/*
+Description: Touch sample pipeline between the XPT2046 and LVGL. Each input poll takes TOUCH_OVERSAMPLE readings;
+the pressure decides press/release with hysteresis (a press needs TOUCH_Z_PRESS, it only ends below
+TOUCH_Z_RELEASE) and a debounce of a few polls, the position is the median of the readings (a single bad conversion
+cannot move the pointer) smoothed by an integer IIR filter. Integer math only, at most TOUCH_OVERSAMPLE_MAX
+readings sorted per poll, so the cost per poll is bounded. Hardware independent, unit tested on the host.
+*/
+
+#ifndef TOUCH_FILTER_H
+#define TOUCH_FILTER_H
+
+#include <stdint.h>
+
+#ifndef TOUCH_OVERSAMPLE
+#define TOUCH_OVERSAMPLE 5         // Readings per poll (odd, so the median is one of them)
+#endif
+#define TOUCH_OVERSAMPLE_MAX 9     // Readings per poll the filter looks at, at most
+#ifndef TOUCH_Z_PRESS
+#define TOUCH_Z_PRESS 600          // Pressure a press has to reach (TFT_eSPI's getTouch() threshold)
+#endif
+#ifndef TOUCH_Z_RELEASE
+#define TOUCH_Z_RELEASE 350        // Pressure below which a press starts to end
+#endif
+#ifndef TOUCH_PRESS_POLLS
+#define TOUCH_PRESS_POLLS 2        // Pressed polls in a row before a press is reported (spurious clicks)
+#endif
+#ifndef TOUCH_RELEASE_POLLS
+#define TOUCH_RELEASE_POLLS 2      // Released polls in a row before a release is reported (pressure dips)
+#endif
+#ifndef TOUCH_IIR_SHIFT
+#define TOUCH_IIR_SHIFT 1          // Smoothing: position += (median - position) / 2^shift
+#endif
+#define TOUCH_FILTER_FRAC 4        // Fraction bits of the filtered position
+
+// One reading of the controller, in screen coordinates
+struct touch_sample_t {
+  int16_t x;
+  int16_t y;
+  uint16_t z;  // Pressure, 0 if the panel is not touched
+};
+
+// Filter state, one per touch panel
+struct touch_filter_t {
+  bool pressed;     // Reported state
+  uint8_t pending;  // Polls in a row that disagree with pressed
+  int32_t x, y;     // Filtered position, TOUCH_FILTER_FRAC fraction bits
+};
+
+void touch_filter_init(touch_filter_t *f);  // Released, no position
+bool touch_filter_update(touch_filter_t *f, const touch_sample_t *samples, uint8_t count,
+                         int16_t *x, int16_t *y);  // One poll; true while pressed, position in x/y
+
+#endif // TOUCH_FILTER_H
@@ -0,0 +1,22 @@
+/*
+Description: PENIRQ line of the XPT2046 touch controller. The line is low while the panel is pressed and an edge
+interrupt latches short taps, so the LVGL read callback can tell "nobody touched the screen" without an SPI
+transaction and leave the shared bus to the display flushes. The interrupt also wakes the main loop
+(loop_sched.h). Without the line (TOUCH_IRQ_PIN < 0) every poll reads the controller as before.
+*/
+
+#ifndef TOUCH_IRQ_H
+#define TOUCH_IRQ_H
+
+#include <stdint.h>
+
+#ifndef TOUCH_IRQ_PIN
+#define TOUCH_IRQ_PIN -1   // GPIO of the XPT2046 PENIRQ (T_IRQ) output, -1 if not wired
+#endif
+
+bool touch_irq_begin(int8_t pin);  // Attach the interrupt; false if the line is not wired
+bool touch_irq_pending();          // Panel pressed now or tapped since the last clear (always true if not wired)
+void touch_irq_clear();            // Forget latched edges (after reading the controller, whose conversions toggle PENIRQ)
+uint32_t touch_irq_skip_count();   // Polls answered without reading the controller
+
+#endif // TOUCH_IRQ_H
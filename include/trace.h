@@ -0,0 +1,58 @@
+/*
+Description: Timing trace of the hot paths. Trace points record a microsecond timestamp, the core and a begin/end
+marker into a fixed RAM ring (8 bytes each, oldest overwritten), cheap enough to leave around every sensor command
+and display flush. Sending 't' on the serial monitor dumps the ring as text; tools/trace2json.py turns the dump into
+Chrome/Perfetto trace JSON, which shows per core where the time of a slow unlock went: sensor commands (UART plus
+sensor processing), LVGL rendering or the SPI flush. The TRACE_* macros compile to nothing unless TRACE_ENABLED is
+defined.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#ifndef TRACE_RING
+#define TRACE_RING 512  // Records kept (power of two), 4 KB
+#endif
+
+// What a trace point measures; names are in trace.cpp and in every dump
+enum trace_event_t {
+  TRACE_SCAN = 0,       // getFingerprintID(): one scan on the fingerprint task
+  TRACE_GET_IMAGE,      // getImage command
+  TRACE_IMAGE2TZ,       // image2Tz command
+  TRACE_SEARCH,         // 1:N search (all commands of the strategy)
+  TRACE_ENROLL_STEP,    // One enrollment state machine step, arg = state
+  TRACE_LVGL,           // lv_timer_handler(): rendering and input
+  TRACE_LABEL,          // Status label text changed (instant; the redraw shows up in lvgl and flush)
+  TRACE_FLUSH,          // One stripe from my_disp_flush() to the end of its DMA transfer
+  TRACE_RESULT,         // Scan result applied on the LVGL thread, arg = status code
+  TRACE_EVENT_COUNT
+};
+
+// One trace point, as stored in the ring
+struct trace_record_t {
+  uint32_t us;     // Timestamp, microseconds since boot (wraps after 71 minutes)
+  uint8_t event;   // trace_event_t
+  char phase;      // 'B' begin, 'E' end, 'I' instant
+  uint8_t core;    // Core (thread) that recorded it
+  uint8_t arg;     // Event specific
+};
+
+#ifdef TRACE_ENABLED
+#define TRACE_BEGIN(event, arg) trace_point((event), 'B', (arg))
+#define TRACE_END(event, arg) trace_point((event), 'E', (arg))
+#define TRACE_INSTANT(event, arg) trace_point((event), 'I', (arg))
+#else
+#define TRACE_BEGIN(event, arg) do {} while (0)
+#define TRACE_END(event, arg) do {} while (0)
+#define TRACE_INSTANT(event, arg) do {} while (0)
+#endif
+
+void trace_point(uint8_t event, char phase, uint8_t arg);  // Record one trace point (any task)
+uint16_t trace_read(trace_record_t *out, uint16_t max);   // Copy the newest records, oldest first
+const char *trace_event_name(uint8_t event);              // Name used in dumps
+void trace_dump();                                        // Print the ring on Serial for tools/trace2json.py
+void trace_clear();                                       // Forget all records
+
+#endif // TRACE_H
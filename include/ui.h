@@ -0,0 +1,38 @@
+/*
+Description: LVGL user interface of the fingerprint terminal (widgets, mode flags and event handlers).
+*/
+
+#ifndef UI_H
+#define UI_H
+
+#include <stdint.h>
+#include <lvgl.h>
+#include "user_dir.h"
+
+// Global objects for UI elements
+extern lv_obj_t *fingerLabel;     // Label to display fingerprint status messages
+extern lv_obj_t *scanButton;      // Button to initiate fingerprint scanning (main menu)
+extern lv_obj_t *enrollButton;    // Button to start fingerprint enrollment
+extern lv_obj_t *inputTextArea;   // Text area for the user name during enrollment (NULL until first used)
+extern lv_obj_t *keyboard;        // Virtual keyboard for the user name (NULL until first used)
+extern lv_obj_t *idKeypad;        // Numeric keypad for the ID (NULL until Enroll, see id_keypad.h)
+extern lv_obj_t *idLabel;         // Label to display entered ID
+extern lv_obj_t *returnButton;    // Button to cancel the enrollment (NULL until the enrolling screen is built)
+
+extern uint16_t id;  // Fingerprint ID to be enrolled
+extern char enrollName[USER_NAME_MAX + 1];  // Name entered for the ID being enrolled
+
+// Flags for modes
+extern bool enrollingMode; // True when enrollment is active
+extern bool scanningMode;  // True when scanning is active
+
+void ui_create();                                  // Create the status label and the main menu
+void return_to_main_menu();                        // Show the main menu and reset the modes
+void enlarge_button(lv_obj_t *button);             // Enlarge a button (used for return button)
+
+void return_button_event_handler(lv_event_t *e);   // Event handler for the Return button
+void scan_button_event_handler(lv_event_t *e);     // Event handler for the Scan button
+void enroll_button_event_handler(lv_event_t *e);   // Event handler for the Enroll button
+void keyboard_event_handler(lv_event_t *e);        // Event handler for the on-screen keyboard (name)
+
+#endif // UI_H
@@ -0,0 +1,41 @@
+/*
+Description: Render benchmark for the UI states of the fingerprint terminal. Runs on the device (results over
+Serial) and on the native host build (framebuffer driver), with the same measurement code on both.
+*/
+
+#ifndef UI_BENCH_H
+#define UI_BENCH_H
+
+#include <stdint.h>
+#include <lvgl.h>
+
+#ifndef UI_BENCH_ITERATIONS
+#define UI_BENCH_ITERATIONS 10  // Full refreshes averaged per state
+#endif
+
+#ifndef UI_BENCH_RELABELS
+#define UI_BENCH_RELABELS 1000  // Status label changes timed for the allocator comparison
+#endif
+
+#define UI_BENCH_STATE_COUNT 7  // Main menu, scanning, ID keypad, name entry, enrolling, result, main menu again
+
+// Cost of one refresh
+struct ui_bench_sample_t {
+  uint32_t us;       // Time from the start of rendering until the last flush completed
+  uint32_t flushes;  // Number of flush callback calls
+  uint32_t px;       // Invalidated (flushed) area in pixels
+};
+
+// Result for one UI state
+struct ui_bench_result_t {
+  const char *state;             // State name
+  ui_bench_sample_t transition;  // Refresh caused by entering the state (only what the handlers invalidated)
+  ui_bench_sample_t full;        // Full-screen refresh in this state, averaged over UI_BENCH_ITERATIONS
+  ui_bench_sample_t keypress;    // Refresh after one keypress, averaged (keypad and keyboard screens, else 0)
+  uint32_t ram;                  // LVGL heap taken by building the screen (keypad and keyboard screens, else 0)
+};
+
+void ui_bench_run(lv_disp_t *disp, ui_bench_result_t results[UI_BENCH_STATE_COUNT]); // Walk through all states
+void ui_bench_print(const ui_bench_result_t results[UI_BENCH_STATE_COUNT]);          // Table and heap figures on Serial
+
+#endif // UI_BENCH_H
@@ -0,0 +1,35 @@
+/*
+Description: Screen navigator of the fingerprint terminal. Each UI mode is its own LVGL screen, built by its
+builder the first time it is shown and kept afterwards. ui_nav_go() loads a screen with lv_scr_load() but only
+redraws the widgets of the screen that is left and of the one that is loaded, not the whole display: all screens
+use the default screen background, so the area outside their widgets looks the same on every screen. The shared
+widget (the status label) moves along with every load and is only redrawn when its text changes.
+*/
+
+#ifndef UI_NAV_H
+#define UI_NAV_H
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// Screens, one per UI mode
+enum ui_screen_t {
+  UI_SCREEN_MENU = 0,   // Scan and Enroll buttons
+  UI_SCREEN_SCAN,       // Scanning, Return button
+  UI_SCREEN_ID_ENTRY,   // Numeric keypad for the ID
+  UI_SCREEN_NAME_ENTRY, // Text area and keyboard for the name
+  UI_SCREEN_ENROLL,     // Enrollment running, Return button
+  UI_SCREEN_RESULT,     // Outcome of an enrollment, no buttons
+  UI_SCREEN_COUNT
+};
+
+typedef void (*ui_screen_build_t)(lv_obj_t *screen);  // Create a screen's widgets
+
+void ui_nav_begin(const ui_screen_build_t builders[UI_SCREEN_COUNT], lv_obj_t *shared); // The active screen becomes
+                                                      // the menu, built now; shared moves along (may be NULL)
+void ui_nav_go(ui_screen_t screen);                   // Show a screen (built on first use)
+ui_screen_t ui_nav_current();                         // Screen shown now
+lv_obj_t *ui_nav_screen(ui_screen_t screen);          // Screen object, NULL until it has been built
+uint32_t ui_nav_transition_px();                      // Area invalidated by the last transition, in pixels
+
+#endif // UI_NAV_H
@@ -0,0 +1,28 @@
+/*
+Description: User directory mapping fingerprint IDs to names. Names live in a fixed-record table on SPIFFS; an
+in-RAM index from ID to record number is built once at boot, so showing the name of a match costs one seek and one
+record read instead of a file scan. Used from the LVGL thread only.
+*/
+
+#ifndef USER_DIR_H
+#define USER_DIR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "fp_slots.h"
+
+#ifndef USER_DIR_PATH
+#define USER_DIR_PATH "/users.dat"   // Table file
+#endif
+#define USER_NAME_MAX 22             // Longest name in bytes, not counting the terminator
+#ifndef USER_DIR_MAX_IDS
+#define USER_DIR_MAX_IDS FP_SLOTS_MAX // IDs 0..USER_DIR_MAX_IDS-1 can have a name (2 bytes of index each)
+#endif
+
+bool user_dir_begin();                                    // Mount, open or create the table and build the index
+bool user_dir_set(uint16_t id, const char *name);         // Store or replace the name of an ID
+bool user_dir_remove(uint16_t id);                        // Forget the name of an ID (template deleted)
+bool user_dir_get(uint16_t id, char *name, size_t len);   // Copy the name of an ID; false if it has none
+uint16_t user_dir_count();                                // Number of named IDs
+
+#endif // USER_DIR_H
@@ -0,0 +1,260 @@
+/*
+Description: Access event log on SPIFFS. Records are 16 bytes
+  seq (4) | uptime (4) | id (2) | confidence (2) | code (1) | boot (1) | CRC-16/CCITT of the first 14 bytes (2)
+all little endian, appended in batches to ACCESS_LOG_SEGMENTS segment files. When the current segment is full the
+next one is truncated and reused, so flash use is bounded and SPIFFS spreads the page writes over the partition.
+At boot the newest record is found by sequence number; a torn record at the end of a segment (power lost during a
+write) fails its CRC and is padded to a whole record so that appends stay aligned.
+The LVGL thread adds records and the writer task removes them, so the ring is only touched inside a short critical
+section; records are copied out under it and written without it. A flash write stops the cache of both cores
+either way, but truncating a segment (an erase, tens of ms) is held back while a scan or enrollment runs.
+*/
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SPIFFS.h>
+#include "access_log.h"
+#include "crc16.h"
+#include "serial_log.h"
+
+#define ACCESS_RECORD_SIZE 16
+
+#ifdef ARDUINO
+static portMUX_TYPE ringLock = portMUX_INITIALIZER_UNLOCKED;  // Ring shared by the LVGL thread and the writer
+#define RING_LOCK() portENTER_CRITICAL(&ringLock)
+#define RING_UNLOCK() portEXIT_CRITICAL(&ringLock)
+#else
+#define RING_LOCK()    // Single thread on the host
+#define RING_UNLOCK()
+#endif
+
+static access_record_t ring[ACCESS_LOG_RING];  // Records not written yet
+static uint16_t ringTail = 0;                  // Oldest pending record
+static uint16_t ringCount = 0;                 // Pending records
+static uint32_t dropped = 0;                   // Records lost to a full ring
+static uint32_t nextSeq = 0;                   // Sequence number of the next record
+static uint8_t boot = 0;                       // Boot number stamped on the records
+static uint8_t segment = 0;                    // Segment being appended to
+static uint16_t segmentRecords = 0;            // Record slots used in it, torn ones included
+static bool ready = false;                     // File system mounted and segments scanned
+static volatile bool quiet = false;            // Scan or enrollment running: no segment erase
+
+/* File name of a segment */
+static void access_log_path(uint8_t index, char *path, size_t len) {
+  snprintf(path, len, ACCESS_LOG_PREFIX "%u.log", index);
+}
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+static uint16_t get16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static uint32_t get32(const uint8_t *p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+
+static void access_log_encode(const access_record_t *rec, uint8_t *buf) {
+  put32(buf, rec->seq);
+  put32(buf + 4, rec->uptime);
+  put16(buf + 8, rec->id);
+  put16(buf + 10, rec->confidence);
+  buf[12] = rec->code;
+  buf[13] = rec->boot;
+  put16(buf + 14, crc16_ccitt(buf, 14));
+}
+
+/* Decode a record; false if its CRC does not match (torn, padding or erased) */
+static bool access_log_decode(const uint8_t *buf, access_record_t *rec) {
+  if (get16(buf + 14) != crc16_ccitt(buf, 14)) return false;
+  rec->seq = get32(buf);
+  rec->uptime = get32(buf + 4);
+  rec->id = get16(buf + 8);
+  rec->confidence = get16(buf + 10);
+  rec->code = buf[12];
+  rec->boot = buf[13];
+  return true;
+}
+
+/* Read a segment backwards from record slot `from`, newest first; returns the records copied */
+static uint16_t access_log_read_back(File &f, int32_t from, access_record_t *out, uint16_t max) {
+  uint16_t n = 0;
+  uint8_t buf[ACCESS_RECORD_SIZE];
+  for (int32_t slot = from; slot >= 0 && n < max; slot--) {
+    if (!f.seek(slot * ACCESS_RECORD_SIZE) || f.read(buf, sizeof(buf)) != sizeof(buf)) continue;
+    if (access_log_decode(buf, &out[n])) n++;
+  }
+  return n;
+}
+
+#ifdef ARDUINO
+/* Writer task: the only place that writes the log to flash */
+static void access_log_task(void *arg) {
+  for (;;) {
+    access_log_poll();
+    vTaskDelay(pdMS_TO_TICKS(ACCESS_LOG_DRAIN_MS));
+  }
+}
+#endif
+
+bool access_log_begin() {
+  ready = false;
+  nextSeq = 0;
+  boot = 0;
+  segment = 0;
+  segmentRecords = 0;
+  if (!SPIFFS.begin(true)) {
+    LOG_W("Access log: file system not available, events stay in RAM.");
+    return false;
+  }
+
+  bool found = false;
+  access_record_t last;
+  for (uint8_t i = 0; i < ACCESS_LOG_SEGMENTS; i++) {
+    char path[32];
+    access_log_path(i, path, sizeof(path));
+    if (!SPIFFS.exists(path)) continue;
+    File f = SPIFFS.open(path, "r");
+    if (!f) continue;
+    uint32_t slots = (f.size() + ACCESS_RECORD_SIZE - 1) / ACCESS_RECORD_SIZE;
+    if (access_log_read_back(f, (int32_t)slots - 1, &last, 1) && (!found || last.seq >= nextSeq)) {
+      found = true;
+      nextSeq = last.seq + 1;
+      boot = last.boot + 1;
+      segment = i;
+    }
+    f.close();
+  }
+
+  char path[32];
+  access_log_path(segment, path, sizeof(path));
+  File f = SPIFFS.open(path, "a");
+  if (!f) {
+    LOG_E("Access log: cannot open " ACCESS_LOG_PREFIX " segment, events stay in RAM.");
+    return false;
+  }
+  uint32_t size = f.size();
+  while (size % ACCESS_RECORD_SIZE) {  // Torn tail: pad it to a whole (invalid) record
+    f.write(0xFF);
+    size++;
+  }
+  f.close();
+  segmentRecords = size / ACCESS_RECORD_SIZE;
+  ready = true;
+
+  // Records buffered before begin() get numbers after the ones on flash
+  RING_LOCK();
+  for (uint16_t i = 0; i < ringCount; i++) {
+    access_record_t *rec = &ring[(ringTail + i) % ACCESS_LOG_RING];
+    rec->seq = nextSeq++;
+    rec->boot = boot;
+  }
+  RING_UNLOCK();
+  LOG_I("Access log: segment %u, %u records, next #%lu", segment, segmentRecords, (unsigned long)nextSeq);
+#ifdef ARDUINO
+  static TaskHandle_t writer = NULL;
+  if (!writer && xTaskCreatePinnedToCore(access_log_task, "accesslog", ACCESS_LOG_STACK, NULL, ACCESS_LOG_PRIORITY,
+                                         &writer, ACCESS_LOG_CORE) != pdPASS) {
+    LOG_E("Access log: writer task not started, events stay in RAM.");
+    return false;
+  }
+#endif
+  return true;
+}
+
+void access_log_add(uint8_t code, uint16_t id, uint16_t confidence) {
+  RING_LOCK();
+  if (ringCount == ACCESS_LOG_RING) {  // Flash is failing: keep the newest events
+    ringTail = (ringTail + 1) % ACCESS_LOG_RING;
+    ringCount--;
+    dropped++;
+  }
+  access_record_t *rec = &ring[(ringTail + ringCount) % ACCESS_LOG_RING];
+  rec->seq = nextSeq++;
+  rec->uptime = millis();
+  rec->id = id;
+  rec->confidence = confidence;
+  rec->code = code;
+  rec->boot = boot;
+  ringCount++;
+  RING_UNLOCK();
+}
+
+bool access_log_flush() {
+  if (!ready) return false;
+  while (access_log_pending() > 0) {
+    char path[32];
+    if (segmentRecords >= ACCESS_LOG_SEGMENT_RECORDS) {  // Rotate: the oldest segment makes room
+      if (quiet) return false;  // The erase waits until the scan or enrollment is over
+      segment = (segment + 1) % ACCESS_LOG_SEGMENTS;
+      segmentRecords = 0;
+      access_log_path(segment, path, sizeof(path));
+      File f = SPIFFS.open(path, "w");
+      if (!f) return false;
+      f.close();
+    }
+
+    access_record_t batch[ACCESS_LOG_BATCH];
+    RING_LOCK();
+    uint16_t n = ringCount;
+    if (n > ACCESS_LOG_BATCH) n = ACCESS_LOG_BATCH;
+    if (n > ACCESS_LOG_SEGMENT_RECORDS - segmentRecords) n = ACCESS_LOG_SEGMENT_RECORDS - segmentRecords;
+    for (uint16_t i = 0; i < n; i++) batch[i] = ring[(ringTail + i) % ACCESS_LOG_RING];
+    RING_UNLOCK();
+
+    uint8_t buf[ACCESS_LOG_BATCH * ACCESS_RECORD_SIZE];
+    for (uint16_t i = 0; i < n; i++) access_log_encode(&batch[i], &buf[i * ACCESS_RECORD_SIZE]);
+
+    access_log_path(segment, path, sizeof(path));
+    File f = SPIFFS.open(path, "a");
+    if (!f) return false;
+    size_t written = f.write(buf, n * ACCESS_RECORD_SIZE);
+    f.close();
+
+    uint16_t done = written / ACCESS_RECORD_SIZE;  // Whole records on flash
+    uint32_t end = batch[0].seq + done;            // First sequence number not written
+    RING_LOCK();
+    // A full ring may have dropped some of them meanwhile: remove by sequence number, not by count
+    while (ringCount > 0 && (int32_t)(ring[ringTail].seq - end) < 0) {
+      ringTail = (ringTail + 1) % ACCESS_LOG_RING;
+      ringCount--;
+    }
+    RING_UNLOCK();
+    segmentRecords += done;
+    if (done < n) {  // File system full: a torn record may be left, continue in the next segment
+      segmentRecords = ACCESS_LOG_SEGMENT_RECORDS;
+      return false;
+    }
+  }
+  return true;
+}
+
+void access_log_poll() {
+  RING_LOCK();
+  bool due = ringCount >= ACCESS_LOG_BATCH ||
+             (ringCount > 0 && millis() - ring[ringTail].uptime >= ACCESS_LOG_FLUSH_MS);
+  RING_UNLOCK();
+  if (due) access_log_flush();
+}
+
+void access_log_set_quiet(bool q) { quiet = q; }
+
+uint16_t access_log_pending() { return ringCount; }
+
+uint32_t access_log_dropped() { return dropped; }
+
+uint16_t access_log_recent(access_record_t *out, uint16_t max) {
+  uint16_t n = 0;
+  RING_LOCK();
+  for (int32_t i = ringCount - 1; i >= 0 && n < max; i--) out[n++] = ring[(ringTail + i) % ACCESS_LOG_RING];
+  RING_UNLOCK();
+  if (!ready) return n;
+
+  for (uint8_t k = 0; k < ACCESS_LOG_SEGMENTS && n < max; k++) {
+    uint8_t index = (segment + ACCESS_LOG_SEGMENTS - k) % ACCESS_LOG_SEGMENTS;
+    char path[32];
+    access_log_path(index, path, sizeof(path));
+    if (!SPIFFS.exists(path)) continue;
+    File f = SPIFFS.open(path, "r");
+    if (!f) continue;
+    int32_t slots = (f.size() + ACCESS_RECORD_SIZE - 1) / ACCESS_RECORD_SIZE;
+    n += access_log_read_back(f, slots - 1, &out[n], max - n);
+    f.close();
+  }
+  return n;
+}
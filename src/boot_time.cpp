@@ -0,0 +1,31 @@
+/*
+Description: Boot-phase profiler (see boot_time.h). Marks are only taken from the LVGL thread, so a plain array
+is enough.
+*/
+
+#include <Arduino.h>
+#include "boot_time.h"
+#include "serial_log.h"
+
+static boot_phase_t phases[BOOT_PHASES_MAX];
+static uint8_t phaseCount = 0;
+
+void boot_phase(const char *name) {
+  if (phaseCount == BOOT_PHASES_MAX) return;
+  phases[phaseCount].name = name;
+  phases[phaseCount].us = micros();
+  phaseCount++;
+}
+
+uint8_t boot_phase_count() { return phaseCount; }
+
+const boot_phase_t *boot_phase_at(uint8_t i) { return i < phaseCount ? &phases[i] : NULL; }
+
+void boot_report() {
+  uint32_t start = 0;  // Application start
+  for (uint8_t i = 0; i < phaseCount; i++) {
+    LOG_I("Boot %-16s %6lu ms, done at %6lu ms", phases[i].name,
+          (unsigned long)(phases[i].us - start) / 1000, (unsigned long)phases[i].us / 1000);
+    start = phases[i].us;
+  }
+}
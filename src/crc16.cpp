@@ -0,0 +1,15 @@
+/*
+Description: Bitwise CRC-16/CCITT-FALSE. The records it protects are a few bytes long, so a table is not worth its
+512 bytes of flash.
+*/
+
+#include "crc16.h"
+
+uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= (uint16_t)*data++ << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
@@ -0,0 +1,181 @@
+/*
+Description: LVGL draw buffers (see draw_buf.h). The buffers are reallocated only between refreshes, after the last
+stripe has left the bus. The host build allocates everything with malloc() and has no PSRAM.
+*/
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include "draw_buf.h"
+#include "serial_log.h"
+#ifdef ARDUINO
+#include <esp_heap_caps.h>  // DMA-capable internal RAM and PSRAM
+#endif
+
+static lv_disp_draw_buf_t *drawBuf = NULL;  // LVGL's descriptor, re-initialised on every change
+static uint16_t bufWidth = 0;               // Screen width in pixels
+static uint16_t bufHeight = 0;              // Screen height in lines
+static uint16_t bufLines = 0;               // Current buffer height
+static lv_color_t *buf1 = NULL;             // LVGL renders here while buf2 is sent
+static lv_color_t *buf2 = NULL;             // LVGL renders here while buf1 is sent (NULL in PSRAM)
+static bool inPsram = false;                // buf1 is in PSRAM, there is no buf2
+
+/* One buffer of the given size, from DMA-capable internal RAM or from PSRAM */
+static lv_color_t *buf_alloc(size_t bytes, bool psram) {
+#ifdef ARDUINO
+  return (lv_color_t *)heap_caps_malloc(bytes, psram ? MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT
+                                                     : MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+#else
+  (void)psram;
+  return (lv_color_t *)malloc(bytes);
+#endif
+}
+
+/* Internal RAM left for everything else */
+static uint32_t internal_free() {
+#ifdef ARDUINO
+  return heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+#else
+  return UINT32_MAX;
+#endif
+}
+
+static void buf_release() {
+  free(buf1);
+  free(buf2);
+  buf1 = buf2 = NULL;
+}
+
+/* Allocate the buffers: two in internal RAM, else (full frame, or if allowed as a fallback) one in PSRAM. PSRAM
+   stripes are sent by a blocking transfer, so LVGL could never render into a second one meanwhile */
+static bool buf_acquire(uint16_t lines, bool allowPsram) {
+  size_t bytes = (size_t)bufWidth * lines * sizeof(lv_color_t);
+  bool psram = lines >= bufHeight;  // A full frame (150 KB) never fits in internal RAM
+  if (!psram) {
+    buf1 = buf_alloc(bytes, false);
+    buf2 = buf_alloc(bytes, false);
+    if (buf1 && buf2) {
+      inPsram = false;
+      return true;
+    }
+    buf_release();
+    psram = allowPsram;
+  }
+  if (!psram) return false;
+  buf1 = buf_alloc(bytes, true);
+  if (!buf1) return false;
+#ifdef ARDUINO
+  inPsram = true;
+#endif
+  return true;
+}
+
+/* Wait until LVGL has no stripe in flight, so the buffers can be freed */
+static void flush_wait(lv_disp_drv_t *drv) {
+  while (drv->draw_buf->flushing) {
+    if (drv->wait_cb) drv->wait_cb(drv);  // my_disp_wait() completes the DMA transfer
+  }
+}
+
+/* Replace the buffers and tell LVGL */
+static bool buf_change(lv_disp_t *disp, uint16_t lines, bool allowPsram) {
+  flush_wait(disp->driver);
+  buf_release();
+  bool ok = buf_acquire(lines, allowPsram);
+  if (ok) {
+    bufLines = lines;
+  } else if (!buf_acquire(bufLines, true)) {  // Just freed, so the old size fits again
+    LOG_E("Draw buffers lost.");
+    return false;
+  }
+  lv_disp_draw_buf_init(drawBuf, buf1, buf2, (uint32_t)bufWidth * bufLines);
+  lv_obj_invalidate(lv_disp_get_scr_act(disp));  // Nothing has been rendered into the new buffers yet
+  return ok;
+}
+
+uint16_t draw_buf_resolve(int16_t option, uint16_t height) {
+  switch (option) {
+    case DRAW_BUF_AUTO:    return 0;
+    case DRAW_BUF_QUARTER: return height / 4;
+    case DRAW_BUF_HALF:    return height / 2;
+    case DRAW_BUF_FULL:    return height;
+    default:
+      if (option < 0) return DRAW_BUF_FALLBACK_LINES;  // Not a known fraction
+      return (uint16_t)option < height ? option : height;
+  }
+}
+
+uint8_t draw_buf_pick(const draw_buf_trial_t *trials, uint8_t count) {
+  uint8_t fastest = count;
+  for (uint8_t i = 0; i < count; i++) {
+    if (trials[i].fits && (fastest == count || trials[i].us < trials[fastest].us)) fastest = i;
+  }
+  if (fastest == count) return count;  // Nothing fits
+
+  uint8_t best = fastest;
+  uint32_t limit = trials[fastest].us + trials[fastest].us * DRAW_BUF_TUNE_TIE_PCT / 100;
+  for (uint8_t i = 0; i < count; i++) {
+    if (trials[i].fits && trials[i].us <= limit && trials[i].lines < trials[best].lines) best = i;
+  }
+  return best;
+}
+
+bool draw_buf_begin(lv_disp_draw_buf_t *buf, uint16_t width, uint16_t height, int16_t option) {
+  drawBuf = buf;
+  bufWidth = width;
+  bufHeight = height;
+  bufLines = draw_buf_resolve(option, height);
+  if (bufLines == 0) bufLines = DRAW_BUF_FALLBACK_LINES;  // Auto-tune replaces it once the UI exists
+
+  if (!buf_acquire(bufLines, true)) {
+    LOG_W("No RAM for %u-line draw buffers, using %u lines.", bufLines, DRAW_BUF_FALLBACK_LINES);
+    bufLines = DRAW_BUF_FALLBACK_LINES;
+    if (!buf_acquire(bufLines, false)) return false;
+  }
+  lv_disp_draw_buf_init(drawBuf, buf1, buf2, (uint32_t)bufWidth * bufLines);
+  LOG_I("Draw buffers: %s %u lines in %s.", buf2 ? "2 x" : "1 x", bufLines, inPsram ? "PSRAM" : "internal RAM");
+  return true;
+}
+
+bool draw_buf_set_lines(lv_disp_t *disp, int16_t option) {
+  uint16_t lines = draw_buf_resolve(option, bufHeight);
+  if (lines == 0) return draw_buf_autotune(disp) != 0;
+  if (lines == bufLines) return true;
+  return buf_change(disp, lines, true);
+}
+
+uint16_t draw_buf_lines() { return bufLines; }
+
+bool draw_buf_in_psram() { return inPsram; }
+
+/* Average time of a full-screen refresh with the current buffers */
+static uint32_t tune_refresh_us(lv_disp_t *disp) {
+  flush_wait(disp->driver);
+  uint32_t start = micros();
+  for (int i = 0; i < DRAW_BUF_TUNE_REFRESHES; i++) {
+    lv_obj_invalidate(lv_disp_get_scr_act(disp));
+    lv_refr_now(disp);
+    flush_wait(disp->driver);  // Count the last stripe's transfer too
+  }
+  return (micros() - start) / DRAW_BUF_TUNE_REFRESHES;
+}
+
+uint16_t draw_buf_autotune(lv_disp_t *disp) {
+  const uint16_t candidates[DRAW_BUF_TUNE_MAX] = {10, 20, 30, 40, (uint16_t)(bufHeight / 4), (uint16_t)(bufHeight / 2)};
+  draw_buf_trial_t trials[DRAW_BUF_TUNE_MAX];
+
+  for (uint8_t i = 0; i < DRAW_BUF_TUNE_MAX; i++) {
+    trials[i] = {candidates[i], 0, false};
+    // Only internal RAM: a PSRAM stripe is always slower than a smaller one sent by DMA
+    if (!buf_change(disp, candidates[i], false)) continue;
+    if (internal_free() < DRAW_BUF_RESERVE) continue;  // Fits, but starves the rest of the firmware
+    trials[i].fits = true;
+    trials[i].us = tune_refresh_us(disp);
+    LOG_I("Draw buffer %3u lines: %6lu us per full refresh", candidates[i], (unsigned long)trials[i].us);
+  }
+
+  uint8_t best = draw_buf_pick(trials, DRAW_BUF_TUNE_MAX);
+  uint16_t lines = best < DRAW_BUF_TUNE_MAX ? trials[best].lines : DRAW_BUF_FALLBACK_LINES;
+  buf_change(disp, lines, false);
+  LOG_I("Draw buffers: 2 x %u lines picked by auto-tune.", bufLines);
+  return bufLines;
+}
@@ -0,0 +1,186 @@
+/*
+Description: Fingerprint enrollment state machine. Replaces the blocking enrollment routine whose busy-wait loops
+(waiting for the finger to be lifted and placed again) and delay() calls froze the UI for the whole enrollment.
+Each call to handleFingerprintEnrollment() runs at most one sensor command and every waiting state has a timeout.
+The state machine only talks to the sensor; what to show for each state is decided by the listener.
+*/
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+#include "enroll.h"
+#include "finger_detect.h"
+#include "fp_slots.h"
+#include "serial_log.h"
+#include "trace.h"
+
+extern Adafruit_Fingerprint finger;  // Fingerprint sensor (defined in main.cpp)
+
+static enroll_state_t state = ENROLL_IDLE;  // Current state
+static enroll_listener_t listener = NULL;   // Receives state changes
+static uint16_t enrollId = 0;               // ID the fingerprint is stored under
+static uint32_t stateStart = 0;             // millis() when the current state was entered
+static uint32_t lastPoll = 0;               // millis() of the last getImage() poll
+
+static const char *const stateNames[] = {
+  "idle", "wait-first", "convert-first", "wait-remove", "wait-second",
+  "convert-second", "create-model", "store", "done", "failed", "timed-out"
+};
+
+/* Switch to a new state, restart its timer and report the change */
+static void enroll_enter(enroll_state_t next, uint8_t code = FINGERPRINT_OK) {
+  enroll_state_t from = state;
+  state = next;
+  stateStart = millis();
+  lastPoll = 0;
+  if (listener) listener(next, from, code);
+}
+
+/* True once ENROLL_POLL_MS has passed since the last getImage() poll */
+static bool enroll_poll_due() {
+  uint32_t now = millis();
+  if (lastPoll != 0 && now - lastPoll < ENROLL_POLL_MS) return false;
+  lastPoll = now;
+  return true;
+}
+
+void enroll_set_listener(enroll_listener_t l) { listener = l; }
+
+bool enroll_start(uint16_t newId) {
+  if (newId >= fp_slots_capacity()) {  // Past the bitmap nothing says whether the slot is free
+    LOG_W("ID #%u is beyond the %u tracked slots, enrollment refused.", newId, fp_slots_capacity());
+    if (listener) listener(ENROLL_FAILED, ENROLL_IDLE, FINGERPRINT_BADLOCATION);
+    return false;
+  }
+  if (fp_slots_occupied(newId)) {  // Never overwrite someone else's template
+    LOG_W("ID #%u is already in use, enrollment refused.", newId);
+    if (listener) listener(ENROLL_FAILED, ENROLL_IDLE, FINGERPRINT_BADLOCATION);
+    return false;
+  }
+  enrollId = newId;
+  LOG_I("Enrolling ID #%u", enrollId);
+  enroll_enter(ENROLL_WAIT_FIRST);  // Prompt user to place finger for enrollment
+  return true;
+}
+
+bool handleFingerprintEnrollment() {
+  uint32_t elapsed = millis() - stateStart; // Time spent in the current state
+  uint8_t p;
+
+  switch (state) {
+    case ENROLL_IDLE:
+      return false;
+
+    case ENROLL_WAIT_FIRST:
+    case ENROLL_WAIT_SECOND:
+      if (elapsed > ENROLL_FINGER_TIMEOUT_MS) {
+        LOG_W("Enrollment timed out.");
+        enroll_enter(ENROLL_TIMED_OUT);
+        break;
+      }
+      if (!finger_detect_present()) break;  // Touch line idle, no need to ask the sensor
+      if (!enroll_poll_due()) break;
+      TRACE_BEGIN(TRACE_ENROLL_STEP, state);
+      p = finger.getImage();  // Capture the fingerprint image
+      TRACE_END(TRACE_ENROLL_STEP, p);
+      if (p == FINGERPRINT_NOFINGER) break;  // Keep waiting
+      if (p != FINGERPRINT_OK) {
+        LOG_W("Error capturing image.");  // General error for image capture
+        enroll_enter(ENROLL_FAILED, p);
+        break;
+      }
+      LOG_D("Image taken");  // Debug message for successful image capture
+      enroll_enter(state == ENROLL_WAIT_FIRST ? ENROLL_CONVERT_FIRST : ENROLL_CONVERT_SECOND);
+      break;
+
+    case ENROLL_CONVERT_FIRST:
+      TRACE_BEGIN(TRACE_ENROLL_STEP, state);
+      p = finger.image2Tz(1);  // Convert image to a fingerprint template
+      TRACE_END(TRACE_ENROLL_STEP, p);
+      if (p != FINGERPRINT_OK) {
+        LOG_W("Failed to process image.");
+        enroll_enter(ENROLL_FAILED, p);
+        break;
+      }
+      LOG_I("Remove finger and place it again.");  // Prompt to place the same finger again
+      enroll_enter(ENROLL_WAIT_REMOVE);
+      break;
+
+    case ENROLL_WAIT_REMOVE:
+      if (elapsed > ENROLL_FINGER_TIMEOUT_MS) {
+        LOG_W("Enrollment timed out.");
+        enroll_enter(ENROLL_TIMED_OUT);
+        break;
+      }
+      if (finger_detect_wired()) {
+        if (finger_detect_present()) break;  // Finger still on the sensor
+      } else {
+        if (!enroll_poll_due()) break;
+        TRACE_BEGIN(TRACE_ENROLL_STEP, state);
+        p = finger.getImage();
+        TRACE_END(TRACE_ENROLL_STEP, p);
+        if (p != FINGERPRINT_NOFINGER) break;  // Finger still on the sensor
+      }
+      enroll_enter(ENROLL_WAIT_SECOND);
+      break;
+
+    case ENROLL_CONVERT_SECOND:
+      TRACE_BEGIN(TRACE_ENROLL_STEP, state);
+      p = finger.image2Tz(2);  // Convert the second fingerprint image to template
+      TRACE_END(TRACE_ENROLL_STEP, p);
+      if (p != FINGERPRINT_OK) {
+        LOG_W("Failed to capture second image.");
+        enroll_enter(ENROLL_FAILED, p);
+        break;
+      }
+      enroll_enter(ENROLL_CREATE_MODEL);
+      break;
+
+    case ENROLL_CREATE_MODEL:
+      TRACE_BEGIN(TRACE_ENROLL_STEP, state);
+      p = finger.createModel();  // Merge the two templates
+      TRACE_END(TRACE_ENROLL_STEP, p);
+      if (p != FINGERPRINT_OK) {
+        LOG_W("Fingerprints did not match.");
+        enroll_enter(ENROLL_FAILED, p);
+        break;
+      }
+      enroll_enter(ENROLL_STORE);
+      break;
+
+    case ENROLL_STORE:
+      TRACE_BEGIN(TRACE_ENROLL_STEP, state);
+      p = finger.storeModel(enrollId);  // Store the fingerprint with the provided ID
+      TRACE_END(TRACE_ENROLL_STEP, p);
+      if (p != FINGERPRINT_OK) {
+        LOG_E("Failed to store fingerprint.");
+        enroll_enter(ENROLL_FAILED, p);
+        break;
+      }
+      fp_slots_mark(enrollId, true);  // Taken, and searched from the next scan on
+      LOG_I("Fingerprint enrolled successfully.");  // Success message for enrollment
+      enroll_enter(ENROLL_DONE);
+      break;
+
+    case ENROLL_DONE:
+    case ENROLL_TIMED_OUT:
+      if (elapsed < ENROLL_RESULT_MS) break;  // Keep the message on screen
+      enroll_enter(ENROLL_IDLE);  // Listener returns to the main menu
+      break;
+
+    case ENROLL_FAILED:
+      if (elapsed < ENROLL_RESULT_MS) break;  // Keep the error on screen
+      enroll_enter(ENROLL_WAIT_FIRST);  // Try again from the first placement
+      break;
+  }
+  return state != ENROLL_IDLE;
+}
+
+void enroll_cancel() {
+  if (state == ENROLL_IDLE) return;
+  LOG_I("Enrollment cancelled in state %s.", stateNames[state]);
+  state = ENROLL_IDLE;  // No report, the UI already left enrollment mode
+}
+
+enroll_state_t enroll_state() { return state; }
+
+const char *enroll_state_name(enroll_state_t s) { return stateNames[s]; }
@@ -0,0 +1,50 @@
+/*
+Description: Touch/wake line of the fingerprint sensor. An edge interrupt gives a binary semaphore that the
+fingerprint service task blocks on, so with nobody at the reader there is no UART traffic and the task sleeps.
+*/
+
+#include <Arduino.h>
+#include "finger_detect.h"
+#include "serial_log.h"
+
+static int8_t touchPin = -1;                  // GPIO of the touch line, -1 if not wired
+static SemaphoreHandle_t touchSemaphore = NULL; // Given by the interrupt on every touch
+static volatile uint32_t touchCount = 0;      // Touch interrupts since boot
+
+/* Touch line interrupt: wake the fingerprint service task */
+static void IRAM_ATTR finger_detect_isr() {
+  BaseType_t woken = pdFALSE;
+  touchCount++;
+  xSemaphoreGiveFromISR(touchSemaphore, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+bool finger_detect_begin(int8_t pin) {
+  if (pin < 0) return false;  // Not wired, callers poll getImage()
+
+  touchSemaphore = xSemaphoreCreateBinary();
+  if (!touchSemaphore) return false;
+
+  touchPin = pin;
+  pinMode(touchPin, FINGER_TOUCH_ACTIVE_LEVEL == HIGH ? INPUT_PULLDOWN : INPUT_PULLUP); // Idle level if the output floats
+  attachInterrupt(digitalPinToInterrupt(touchPin), finger_detect_isr,
+                  FINGER_TOUCH_ACTIVE_LEVEL == HIGH ? RISING : FALLING);
+  LOG_I("Finger touch line on GPIO %d", touchPin);
+  return true;
+}
+
+bool finger_detect_wired() { return touchPin >= 0; }
+
+bool finger_detect_present() {
+  if (touchPin < 0) return true;  // Unknown, let the caller ask the sensor
+  return digitalRead(touchPin) == FINGER_TOUCH_ACTIVE_LEVEL;
+}
+
+bool finger_detect_wait(uint32_t timeoutMs) {
+  if (touchPin < 0) return true;
+  if (finger_detect_present()) return true;
+  xSemaphoreTake(touchSemaphore, pdMS_TO_TICKS(timeoutMs));  // Sleep until the next touch edge
+  return finger_detect_present();  // A stale edge from an earlier touch does not count
+}
+
+uint32_t finger_detect_touch_count() { return touchCount; }
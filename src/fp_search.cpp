@@ -0,0 +1,101 @@
+/*
+Description: 1:N search strategies. The occupied template IDs of the slot cache are grouped into at most
+FP_SEARCH_MAX_RANGES page ranges, joining runs separated by small gaps since an extra command costs more than
+searching a few empty pages; the ranges are rebuilt whenever the cache changes. All sensor traffic runs on the
+fingerprint service task.
+*/
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+#include "fp_search.h"
+#include "fp_service.h"
+#include "fp_slots.h"
+
+extern Adafruit_Fingerprint finger;  // Fingerprint sensor (defined in main.cpp)
+
+#define FP_SEARCH_BUFFER 1  // Character buffer holding the scanned finger
+
+// One search command: pages start .. start + count - 1
+struct fp_range_t {
+  uint16_t start;
+  uint16_t count;
+};
+
+static fp_range_t ranges[FP_SEARCH_MAX_RANGES];  // Occupied ranges
+static uint8_t rangeCount = 0;
+static uint32_t rangesVersion = 0;               // fp_slots_version() the ranges were built from, 0 = never
+static fp_search_mode_t searchMode = FP_SEARCH_MODE;
+
+/* High-speed search of char buffer 1 over pages start .. start + count - 1 */
+static uint8_t fp_search_fast(uint16_t start, uint16_t count) {
+  uint8_t data[] = {FINGERPRINT_HISPEEDSEARCH, FP_SEARCH_BUFFER, (uint8_t)(start >> 8), (uint8_t)(start & 0xFF),
+                    (uint8_t)(count >> 8), (uint8_t)(count & 0xFF)};
+  uint8_t reply[4];  // Page ID, match score
+  uint8_t p = fp_command(data, sizeof(data), reply, sizeof(reply));
+  if (p != FINGERPRINT_OK) return p;
+  finger.fingerID = ((uint16_t)reply[0] << 8) | reply[1];
+  finger.confidence = ((uint16_t)reply[2] << 8) | reply[3];
+  return FINGERPRINT_OK;
+}
+
+/* Group the occupied IDs into search ranges if the slot cache changed */
+static void fp_search_build_ranges() {
+  uint32_t version = fp_slots_version();
+  if (version == rangesVersion) return;
+
+  uint16_t capacity = finger.capacity;
+  uint16_t tracked = fp_slots_capacity();
+  rangeCount = 0;
+  for (uint16_t id = 0; id <= tracked; id++) {
+    uint16_t count = 1;
+    if (id == tracked) {  // Pages beyond the bitmap are always searched
+      if (capacity <= tracked) break;
+      count = capacity - tracked;
+    } else if (!fp_slots_occupied(id)) {
+      continue;
+    }
+    if (rangeCount) {
+      fp_range_t &last = ranges[rangeCount - 1];
+      uint16_t end = last.start + last.count;
+      if (id - end <= FP_SEARCH_MERGE_GAP || rangeCount == FP_SEARCH_MAX_RANGES) {
+        last.count = id + count - last.start;  // Join the previous range
+        continue;
+      }
+    }
+    ranges[rangeCount].start = id;
+    ranges[rangeCount].count = count;
+    rangeCount++;
+  }
+  rangesVersion = version;
+}
+
+void fp_search_set_mode(fp_search_mode_t mode) { searchMode = mode; }
+
+fp_search_mode_t fp_search_mode() { return searchMode; }
+
+const char *fp_search_mode_name(fp_search_mode_t mode) {
+  switch (mode) {
+    case FP_SEARCH_FULL: return "full";
+    case FP_SEARCH_FAST: return "high-speed";
+    case FP_SEARCH_OCCUPIED: return "occupied ranges";
+  }
+  return "?";
+}
+
+uint8_t fp_search() {
+  if (searchMode == FP_SEARCH_FULL) return finger.fingerSearch();
+  if (searchMode == FP_SEARCH_FAST || !fp_slots_valid()) return fp_search_fast(0, finger.capacity);
+
+  fp_search_build_ranges();
+  for (uint8_t i = 0; i < rangeCount; i++) {
+    uint8_t p = fp_search_fast(ranges[i].start, ranges[i].count);
+    if (p != FINGERPRINT_NOTFOUND) return p;  // Match or sensor error
+  }
+  return FINGERPRINT_NOTFOUND;  // Also for an empty library, without asking the sensor
+}
+
+uint8_t fp_search_range_count() {
+  if (searchMode != FP_SEARCH_OCCUPIED || !fp_slots_valid()) return 1;
+  fp_search_build_ranges();
+  return rangeCount;
+}
@@ -0,0 +1,231 @@
+/*
+Description: Fingerprint service task. Owns the Adafruit_Fingerprint instance after setup(): scans, enrollment
+steps, deletes and template counts all run here, on FP_SERVICE_CORE, and their outcome is posted to the result
+queue for the LVGL thread. An enrollment keeps stepping between commands so it can still be cancelled.
+The sensor handshake can be handed to the task as well, so setup() does not wait for the sensor's UART replies.
+The native build has no FreeRTOS: there the queues are plain rings and fp_service_receive() runs the pending
+commands (and one enrollment step) inline, as if the task had run between two loop() iterations.
+*/
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+#include "fp_service.h"
+#include "enroll.h"
+#include "finger_detect.h"
+#include "fp_search.h"
+#include "fp_slots.h"
+#include "serial_log.h"
+#include "trace.h"
+#include "loop_sched.h"
+
+extern Adafruit_Fingerprint finger;  // Fingerprint sensor (defined in main.cpp)
+
+#ifdef ARDUINO
+static QueueHandle_t commandQueue = NULL; // fp_command_t from the LVGL thread
+static QueueHandle_t resultQueue = NULL;  // fp_result_t to the LVGL thread
+#else
+static fp_command_t commandRing[FP_COMMAND_QUEUE_LENGTH]; // Pending commands (host)
+static fp_result_t resultRing[FP_RESULT_QUEUE_LENGTH];    // Pending results (host)
+static uint8_t commandHead = 0, commandCount = 0;         // Ring positions (host)
+static uint8_t resultHead = 0, resultCount = 0;
+static fp_connect_t pendingConnect = NULL;                // Handshake still to run (host)
+static bool serviceDown = false;                          // Handshake failed, commands stay unanswered (host)
+#endif
+static fp_sensor_state_t sensorState = FP_SENSOR_READY;  // LVGL thread only
+
+// Function to handle fingerprint detection and matching
+uint8_t getFingerprintID(uint16_t *fingerprintId) {
+  TRACE_BEGIN(TRACE_GET_IMAGE, 0);
+  uint8_t p = finger.getImage();
+  TRACE_END(TRACE_GET_IMAGE, p);
+
+  // No finger detected
+  if (p == FINGERPRINT_NOFINGER) return FINGERPRINT_NOFINGER;
+
+  // Check if the image can be converted to features
+  if (p != FINGERPRINT_OK) return p;
+  TRACE_BEGIN(TRACE_IMAGE2TZ, 0);
+  p = finger.image2Tz();
+  TRACE_END(TRACE_IMAGE2TZ, p);
+
+  // Search for a matching fingerprint with the configured strategy
+  if (p != FINGERPRINT_OK) return p;
+  TRACE_BEGIN(TRACE_SEARCH, 0);
+  p = fp_search();
+  TRACE_END(TRACE_SEARCH, p);
+  if (p != FINGERPRINT_OK) return p;
+
+  *fingerprintId = finger.fingerID;  // 16-bit, kept apart from the status codes
+  return FINGERPRINT_OK;
+}
+
+fp_sensor_state_t fp_sensor_state() { return sensorState; }
+
+/* LVGL thread: follow the handshake through the results it fetches */
+static void fp_received(const fp_result_t *result) {
+  if (result->type != FP_RES_READY) return;
+  sensorState = result->code == FINGERPRINT_OK ? FP_SENSOR_READY : FP_SENSOR_MISSING;
+}
+
+uint16_t fp_capacity() { return finger.capacity; }  // Set by getParameters() in the handshake, 0 before
+
+uint8_t fp_command(uint8_t *data, uint16_t len, uint8_t *reply, uint16_t replyLen) {
+  Adafruit_Fingerprint_Packet packet(FINGERPRINT_COMMANDPACKET, len, data);
+  finger.writeStructuredPacket(packet);
+  if (finger.getStructuredPacket(&packet) != FINGERPRINT_OK) return FINGERPRINT_PACKETRECIEVEERR;
+  if (packet.type != FINGERPRINT_ACKPACKET) return FINGERPRINT_PACKETRECIEVEERR;
+  if (packet.data[0] == FINGERPRINT_OK) memcpy(reply, &packet.data[1], replyLen);  // Data after the code
+  return packet.data[0];
+}
+
+/* Hand a result to the LVGL thread (dropped if it has fallen far behind) */
+static void fp_post(const fp_result_t &result) {
+#ifdef ARDUINO
+  bool queued = xQueueSend(resultQueue, &result, pdMS_TO_TICKS(100)) == pdTRUE;
+  if (queued) loop_sched_wake();  // Apply it now rather than at the next LVGL deadline
+#else
+  bool queued = resultCount < FP_RESULT_QUEUE_LENGTH;
+  if (queued) resultRing[(resultHead + resultCount++) % FP_RESULT_QUEUE_LENGTH] = result;
+#endif
+  if (!queued) LOG_W("Fingerprint result dropped.");
+}
+
+/* Run the sensor handshake and report its outcome */
+static bool fp_connect(fp_connect_t connect) {
+  fp_result_t result = {};
+  result.type = FP_RES_READY;
+  bool ok = connect();
+  result.code = ok ? FINGERPRINT_OK : FINGERPRINT_PACKETRECIEVEERR;
+  fp_post(result);
+  return ok;
+}
+
+/* Forward enrollment state changes to the LVGL thread */
+static void fp_enroll_listener(enroll_state_t state, enroll_state_t from, uint8_t code) {
+  fp_result_t result = {};
+  result.type = FP_RES_ENROLL;
+  result.code = code;
+  result.state = state;
+  result.from = from;
+  fp_post(result);
+}
+
+/* Run one command on the sensor and post its result */
+static void fp_execute(const fp_command_t &cmd) {
+  fp_result_t result = {};
+  switch (cmd.type) {
+    case FP_CMD_SCAN: {
+      result.type = FP_RES_SCAN;
+      if (!finger_detect_wait(FINGER_TOUCH_WAIT_MS)) {  // Touch line idle: no UART traffic at all
+        result.code = FINGERPRINT_NOFINGER;
+        fp_post(result);
+        break;
+      }
+      TRACE_BEGIN(TRACE_SCAN, 0);
+      result.code = getFingerprintID(&result.id);  // Get the scanned fingerprint ID
+      TRACE_END(TRACE_SCAN, result.code);
+      if (result.code == FINGERPRINT_OK) result.confidence = finger.confidence;
+      fp_post(result);
+      break;
+    }
+    case FP_CMD_ENROLL:
+      enroll_start(cmd.id);  // Stepped by the task loop until it is idle again
+      break;
+    case FP_CMD_CANCEL:
+      enroll_cancel();
+      break;
+    case FP_CMD_DELETE:
+      result.type = FP_RES_DELETE;
+      result.id = cmd.id;
+      result.code = finger.deleteModel(cmd.id);
+      if (result.code == FINGERPRINT_OK) fp_slots_mark(cmd.id, false);
+      fp_post(result);
+      break;
+    case FP_CMD_COUNT:
+      result.type = FP_RES_COUNT;
+      result.code = finger.getTemplateCount();
+      result.count = finger.templateCount;
+      fp_post(result);
+      break;
+  }
+}
+
+#ifdef ARDUINO
+/* Service task: wait for commands, keep a running enrollment moving in between */
+static void fp_task(void *arg) {
+  fp_connect_t connect = (fp_connect_t)arg;
+  if (connect && !fp_connect(connect)) {
+    vTaskDelete(NULL);  // No sensor: commands stay queued and unanswered
+  }
+
+  fp_command_t cmd;
+  for (;;) {
+    // While enrolling, wake up regularly so the state machine keeps advancing
+    TickType_t wait = enroll_state() != ENROLL_IDLE ? pdMS_TO_TICKS(FP_SERVICE_STEP_MS) : portMAX_DELAY;
+    if (xQueueReceive(commandQueue, &cmd, wait) == pdTRUE) {
+      fp_execute(cmd);
+    }
+    handleFingerprintEnrollment();  // No-op while idle
+  }
+}
+
+bool fp_service_begin(fp_connect_t connect) {
+  sensorState = connect ? FP_SENSOR_CONNECTING : FP_SENSOR_READY;
+  commandQueue = xQueueCreate(FP_COMMAND_QUEUE_LENGTH, sizeof(fp_command_t));
+  resultQueue = xQueueCreate(FP_RESULT_QUEUE_LENGTH, sizeof(fp_result_t));
+  if (!commandQueue || !resultQueue) return false;
+
+  enroll_set_listener(fp_enroll_listener);
+  return xTaskCreatePinnedToCore(fp_task, "fingerprint", FP_SERVICE_STACK, (void *)connect,
+                                 FP_SERVICE_PRIORITY, NULL, FP_SERVICE_CORE) == pdPASS;
+}
+
+bool fp_service_send(fp_command_type_t type, uint16_t id) {
+  fp_command_t cmd = {type, id};
+  return xQueueSend(commandQueue, &cmd, 0) == pdTRUE;
+}
+
+bool fp_service_receive(fp_result_t *result) {
+  if (xQueueReceive(resultQueue, result, 0) != pdTRUE) return false;
+  fp_received(result);
+  return true;
+}
+#else
+bool fp_service_begin(fp_connect_t connect) {
+  commandHead = commandCount = resultHead = resultCount = 0;
+  pendingConnect = connect;
+  sensorState = connect ? FP_SENSOR_CONNECTING : FP_SENSOR_READY;
+  serviceDown = false;
+  enroll_set_listener(fp_enroll_listener);
+  return true;
+}
+
+bool fp_service_send(fp_command_type_t type, uint16_t id) {
+  if (commandCount == FP_COMMAND_QUEUE_LENGTH) return false;
+  fp_command_t cmd = {type, id};
+  commandRing[(commandHead + commandCount++) % FP_COMMAND_QUEUE_LENGTH] = cmd;
+  return true;
+}
+
+bool fp_service_receive(fp_result_t *result) {
+  // Run what the service task would have run since the last call
+  if (pendingConnect) {
+    serviceDown = !fp_connect(pendingConnect);
+    pendingConnect = NULL;
+  }
+  while (commandCount && !serviceDown) {
+    fp_command_t cmd = commandRing[commandHead];
+    commandHead = (commandHead + 1) % FP_COMMAND_QUEUE_LENGTH;
+    commandCount--;
+    fp_execute(cmd);
+  }
+  if (!serviceDown) handleFingerprintEnrollment();  // No-op while idle
+
+  if (!resultCount) return false;
+  *result = resultRing[resultHead];
+  resultHead = (resultHead + 1) % FP_RESULT_QUEUE_LENGTH;
+  resultCount--;
+  fp_received(result);
+  return true;
+}
+#endif
@@ -0,0 +1,101 @@
+/*
+Description: Template slot cache. One bit per ID in 32-bit words, bit 0 of word 0 being ID 0, the same order as the
+module's index table (instruction 0x1F, 32 bytes per page of 256 IDs). The lowest free ID is kept in nextFree:
+a delete below it moves it down, a store into it moves it up to the next zero bit, found a word at a time, so
+asking for a free ID costs nothing and a run of enrollments scans the bitmap only once.
+Writes happen on the fingerprint service task; the LVGL thread only reads whole words, which the ESP32 does
+atomically, and at worst sees a store or delete one loop() late.
+*/
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+#include "fp_service.h"
+#include "fp_slots.h"
+#include "serial_log.h"
+
+extern Adafruit_Fingerprint finger;  // Fingerprint sensor (defined in main.cpp)
+
+static uint32_t slots[FP_SLOTS_MAX / 32];  // Occupancy bitmap
+static uint16_t tracked = 0;               // IDs covered: min(capacity, FP_SLOTS_MAX)
+static uint16_t nextFree = FP_SLOT_NONE;   // Lowest free ID >= FP_SLOTS_FIRST_ID
+static uint16_t stored = 0;                // Set bits
+static bool valid = false;                 // Bitmap read from the module
+static volatile uint32_t version = 0;      // Bumped on every change
+
+/* Lowest free ID at or above from, FP_SLOT_NONE if there is none */
+static uint16_t fp_slots_find_free(uint16_t from) {
+  for (uint16_t id = from; id < tracked;) {
+    uint32_t free = ~slots[id / 32] >> (id % 32);  // Free bits from id to the end of its word
+    if (free) {
+      id += __builtin_ctz(free);
+      return id < tracked ? id : FP_SLOT_NONE;
+    }
+    id = (id / 32 + 1) * 32;  // Start of the next word
+  }
+  return FP_SLOT_NONE;
+}
+
+uint8_t fp_slots_begin() {
+  memset(slots, 0, sizeof(slots));
+  valid = false;
+  stored = 0;
+  tracked = finger.capacity < FP_SLOTS_MAX ? finger.capacity : FP_SLOTS_MAX;
+  if (finger.capacity > FP_SLOTS_MAX) {
+    LOG_W("Sensor holds %u templates, only IDs below %u are used.", finger.capacity, FP_SLOTS_MAX);
+  }
+  nextFree = fp_slots_find_free(FP_SLOTS_FIRST_ID);
+  version++;
+
+  uint8_t pages = (tracked + FP_SLOTS_INDEX_PAGE - 1) / FP_SLOTS_INDEX_PAGE;
+  for (uint8_t page = 0; page < pages; page++) {
+    uint8_t data[] = {FINGERPRINT_READINDEX, page};
+    uint8_t reply[FP_SLOTS_INDEX_PAGE / 8];
+    uint8_t p = fp_command(data, sizeof(data), reply, sizeof(reply));
+    if (p != FINGERPRINT_OK) {  // Older modules lack the command
+      LOG_W("Template index table not available, overwrites cannot be detected.");
+      return p;
+    }
+    for (uint16_t i = 0; i < FP_SLOTS_INDEX_PAGE; i++) {
+      uint16_t id = page * FP_SLOTS_INDEX_PAGE + i;
+      if (id >= tracked) break;  // Ignore bits past the end of the library
+      if (reply[i / 8] & (1 << (i % 8))) {
+        slots[id / 32] |= 1UL << (id % 32);
+        stored++;
+      }
+    }
+  }
+  nextFree = fp_slots_find_free(FP_SLOTS_FIRST_ID);
+  valid = true;
+  version++;
+  LOG_I("Template slots: %u of %u used, next free ID %u", stored, tracked, nextFree);
+  return FINGERPRINT_OK;
+}
+
+bool fp_slots_valid() { return valid; }
+
+uint16_t fp_slots_capacity() { return tracked; }
+
+bool fp_slots_occupied(uint16_t id) {
+  if (id >= tracked) return false;
+  return slots[id / 32] & (1UL << (id % 32));
+}
+
+void fp_slots_mark(uint16_t id, bool occupied) {
+  if (id >= tracked || fp_slots_occupied(id) == occupied) return;
+  if (occupied) {
+    slots[id / 32] |= 1UL << (id % 32);
+    stored++;
+    if (id == nextFree) nextFree = fp_slots_find_free(id + 1);
+  } else {
+    slots[id / 32] &= ~(1UL << (id % 32));
+    stored--;
+    if (id >= FP_SLOTS_FIRST_ID && (nextFree == FP_SLOT_NONE || id < nextFree)) nextFree = id;
+  }
+  version++;
+}
+
+uint16_t fp_slots_next_free() { return valid ? nextFree : FP_SLOT_NONE; }
+
+uint16_t fp_slots_count() { return stored; }
+
+uint32_t fp_slots_version() { return version; }
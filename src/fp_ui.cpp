@@ -0,0 +1,161 @@
+/*
+Description: LVGL-thread side of the fingerprint service. Sends scan/enroll/cancel commands for the active UI mode
+and turns the typed results posted by the service task into status messages and mode changes. Called from loop().
+*/
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+#include "fp_service.h"
+#include "enroll.h"
+#include "status_label.h"
+#include "user_dir.h"
+#include "access_log.h"
+#include "serial_log.h"
+#include "trace.h"
+#include "boot_time.h"
+#include "ui.h"
+#include "ui_nav.h"
+
+static bool scanPending = false;   // A scan command is queued or running
+static bool enrollActive = false;  // An enrollment was started and has not returned to idle
+
+/* Function to show the result of a fingerprint scan */
+static void scanFingerprint(const fp_result_t *result) {
+  TRACE_INSTANT(TRACE_RESULT, result->code);
+  if (result->code != FINGERPRINT_NOFINGER) access_log_add(result->code, result->id, result->confidence); // RAM only
+  switch (result->code) {
+    case FINGERPRINT_NOFINGER: // No finger detected
+      status_show(STATUS_NO_FINGER); // Update display label
+      LOG_D("No Finger Detected"); // Print message to serial monitor
+      break;
+    case FINGERPRINT_NOTFOUND: // Fingerprint not found
+      status_show(STATUS_NO_MATCH); // Update display label
+      LOG_I("No Match Found"); // Print message to serial monitor
+      break;
+    case FINGERPRINT_OK: { // Fingerprint matched with an ID
+      char name[USER_NAME_MAX + 1];
+      if (user_dir_get(result->id, name, sizeof(name))) {  // One record read, no file scan
+        status_set_fmt("Welcome, %s (ID #%u)", name, result->id); // Update label with name and ID
+      } else {
+        status_set_fmt("Fingerprint ID: %u", result->id); // Update label with ID
+      }
+      LOG_I("Fingerprint ID: %u", result->id); // Print ID message to serial monitor
+      break;
+    }
+    default: // Image or communication error, the next scan tries again
+      status_show(STATUS_READ_ERROR);
+      LOG_W("Scan failed: 0x%02X", result->code);
+      break;
+  }
+}
+
+/* Error message for an enrollment step that failed */
+static const char *enroll_error_text(enroll_state_t failed) {
+  switch (failed) {
+    case ENROLL_CONVERT_FIRST:  return "Failed to process image.";
+    case ENROLL_CONVERT_SECOND: return "Failed to capture second image.";
+    case ENROLL_CREATE_MODEL:   return "Fingerprints did not match.";
+    case ENROLL_STORE:          return "Failed to store fingerprint.";
+    default:                    return "Error capturing image.";
+  }
+}
+
+/* Function to show the progress of the enrollment running on the service task */
+static void showEnrollProgress(const fp_result_t *result) {
+  switch ((enroll_state_t)result->state) {
+    case ENROLL_WAIT_FIRST:
+      status_set_fmt("Place finger to enroll as ID #%u", id);  // Prompt user to place finger for enrollment
+      break;
+    case ENROLL_CONVERT_FIRST:
+    case ENROLL_CONVERT_SECOND:
+      status_set("Image taken, processing...");
+      break;
+    case ENROLL_WAIT_REMOVE:
+      status_set("Remove finger and place it again.");
+      break;
+    case ENROLL_WAIT_SECOND:
+      status_set("Place the same finger again.");
+      break;
+    case ENROLL_DONE:
+      // An empty name also clears any stale name of an earlier user of this ID
+      if (!user_dir_set(id, enrollName) && enrollName[0]) {
+        LOG_E("Failed to store the user name.");
+        status_set_fmt("Enrolled as ID #%u, but the name was not saved.", id);  // The template is stored
+      } else {
+        status_set_fmt("Fingerprint enrolled successfully as ID #%u", id);
+      }
+      ui_nav_go(UI_SCREEN_RESULT);  // Message only, the service returns to idle after ENROLL_RESULT_MS
+      break;
+    case ENROLL_FAILED:
+      if ((enroll_state_t)result->from == ENROLL_IDLE) {
+        // Refused before it started (the ID was taken meanwhile): nothing more will come, pick another ID
+        enrollActive = false;
+        enrollingMode = false;
+        status_set_fmt("ID #%u is already in use.", id);
+        ui_nav_go(UI_SCREEN_ID_ENTRY);
+        break;
+      }
+      status_set(enroll_error_text((enroll_state_t)result->from));
+      break;
+    case ENROLL_TIMED_OUT:
+      status_set("Enrollment timed out.");
+      ui_nav_go(UI_SCREEN_RESULT);
+      break;
+    case ENROLL_IDLE:
+      enrollActive = false;
+      return_to_main_menu();  // Success or timeout message has been shown long enough
+      break;
+    default:
+      break;  // Model creation and storage are quick, keep the current message
+  }
+}
+
+/* Outcome of the sensor handshake run by the service task; the menu refuses Scan and Enroll until then */
+static void sensorConnected(const fp_result_t *result) {
+  boot_phase("sensor handshake");
+  boot_report();  // Last boot phase; the menu was drawn and touchable long before
+  if (result->code != FINGERPRINT_OK) {
+    LOG_E("Fingerprint sensor initialization failed.");
+    status_show(STATUS_NO_SENSOR);
+    return;
+  }
+  LOG_I("Fingerprint sensor initialized.");
+  status_show(STATUS_SELECT);  // Still on the main menu: no mode could be started before
+}
+
+void fingerprint_poll() {
+  // Start or cancel the enrollment to follow enrollingMode (the Return button clears it)
+  if (enrollingMode && !enrollActive) {
+    enrollActive = fp_service_send(FP_CMD_ENROLL, id);
+  } else if (!enrollingMode && enrollActive) {
+    enrollActive = !fp_service_send(FP_CMD_CANCEL);
+  }
+
+  // Keep exactly one scan in flight while scanning
+  if (scanningMode && !scanPending) {
+    scanPending = fp_service_send(FP_CMD_SCAN);
+  }
+
+  fp_result_t result;
+  while (fp_service_receive(&result)) {
+    switch (result.type) {
+      case FP_RES_SCAN:
+        scanPending = false;
+        if (scanningMode) scanFingerprint(&result);  // Ignore a scan that finished after Return
+        break;
+      case FP_RES_ENROLL:
+        if (enrollActive) showEnrollProgress(&result);  // Ignore steps reported after a cancel
+        break;
+      case FP_RES_DELETE:
+        LOG_I("Delete ID #%u: %s", result.id, result.code == FINGERPRINT_OK ? "ok" : "failed");
+        if (result.code == FINGERPRINT_OK) user_dir_remove(result.id);  // The name goes with the template
+        break;
+      case FP_RES_COUNT:
+        LOG_I("Sensor contains %d templates", result.count);
+        break;
+      case FP_RES_READY:
+        sensorConnected(&result);
+        break;
+    }
+  }
+}
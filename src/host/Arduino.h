@@ -0,0 +1,81 @@
+/*
+Description: Minimal Arduino API shim for the native (host) build. Provides the timing functions, the Serial
+object and the Stream/HardwareSerial types used by the hardware independent code and Adafruit_Fingerprint. Time comes from a virtual millisecond clock that only moves when
+delay() or host_clock_advance() is called, so scripted UI runs are deterministic.
+*/
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define HIGH 0x1
+#define LOW 0x0
+#define SERIAL_8N1 0x800001c  // Same value as the ESP32 core, only passed through
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t millis(void);               // Virtual milliseconds since start (also the LVGL tick source)
+uint32_t micros(void);               // Virtual microseconds since start
+void delay(uint32_t ms);             // Advance the virtual clock instead of sleeping
+void host_clock_advance(uint32_t ms); // Advance the virtual clock (used by the host main loop)
+void yield(void);                    // Nothing to yield to on the host
+
+#ifdef __cplusplus
+}
+
+/* Serial replacement that writes to stdout */
+class HostSerial {
+ public:
+  void begin(unsigned long baud) { (void)baud; }    // Nothing to configure on the host
+  size_t print(const char *s);                      // Print a string
+  size_t print(long v);                             // Print a number in decimal
+  size_t println(const char *s = "");               // Print a string followed by a newline
+  size_t println(long v);                           // Print a number followed by a newline
+  int printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))); // Formatted output
+};
+
+extern HostSerial Serial;  // Debug output, same name as on the device
+
+/* Byte stream interface, implemented by the sensor emulator */
+class Stream {
+ public:
+  virtual ~Stream() {}
+  virtual int available() = 0;                          // Bytes ready to read
+  virtual int read() = 0;                               // Next byte, -1 if none
+  virtual int peek() = 0;                               // Next byte without consuming it, -1 if none
+  virtual size_t write(uint8_t b) = 0;                  // Send one byte
+  virtual size_t write(const uint8_t *buf, size_t n) {  // Send a buffer
+    for (size_t i = 0; i < n; i++) write(buf[i]);
+    return n;
+  }
+  virtual void flush() {}
+};
+
+/* UART that is not connected to anything on the host */
+class HardwareSerial : public Stream {
+ public:
+  explicit HardwareSerial(int uart) { (void)uart; }
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rx = -1, int8_t tx = -1) {
+    (void)baud; (void)config; (void)rx; (void)tx;
+  }
+  void updateBaudRate(unsigned long baud) { (void)baud; }
+  void end() {}
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t b) override { (void)b; return 1; }
+  using Stream::write;
+};
+#endif
+
+#endif // HOST_ARDUINO_H
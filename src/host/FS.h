@@ -0,0 +1,63 @@
+/*
+Description: File system shim for the native build, modelled on the ESP32 core's fs::FS / fs::File. Files live in
+a directory of the host (host_fs_set_root()), so code written against SPIFFS or LittleFS runs unchanged on Linux.
+Only what the firmware uses is provided.
+*/
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+/* Open file, backed by a stdio FILE */
+class File {
+ public:
+  File(FILE *f = NULL) : fp(f) {}
+  operator bool() const { return fp != NULL; }
+  size_t write(const uint8_t *buf, size_t size);
+  size_t write(uint8_t b) { return write(&b, 1); }
+  size_t read(uint8_t *buf, size_t size);
+  int read();                                  // One byte, -1 at the end
+  int available();                             // Bytes left after the position
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void flush();
+  void close();
+
+ private:
+  FILE *fp;
+};
+
+/* File system rooted in a host directory */
+class FS {
+ public:
+  bool begin(bool formatOnFail = false);      // Creates the root directory
+  void end() {}
+  bool format();                              // Delete every file
+  File open(const char *path, const char *mode = "r");
+  bool exists(const char *path);
+  bool remove(const char *path);
+  bool rename(const char *from, const char *to);
+  size_t totalBytes();                        // Fixed size, like a 1.4 MB SPIFFS partition
+  size_t usedBytes();                         // Sum of the file sizes
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+void host_fs_set_root(const char *dir);  // Directory that holds the files (default "host_fs")
+
+#endif // HOST_FS_H
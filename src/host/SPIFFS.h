@@ -0,0 +1,12 @@
+/*
+Description: SPIFFS for the native build: an fs::FS rooted in a host directory (see FS.h).
+*/
+
+#ifndef HOST_SPIFFS_H
+#define HOST_SPIFFS_H
+
+#include "FS.h"
+
+extern fs::FS SPIFFS;
+
+#endif // HOST_SPIFFS_H
@@ -0,0 +1,317 @@
+/*
+Description: R30x/R503 protocol emulator. Packets are
+  EF 01 | address (4) | PID (1) | length (2) | payload (length - 2) | checksum (2)
+where the checksum is the 16-bit sum of PID, length and payload. Commands arrive with PID 0x01 and are answered with
+an acknowledge packet (PID 0x07) whose first payload byte is the confirmation code. Responses become readable only
+after the configured latency plus the UART wire time have passed on the virtual clock, which the Adafruit library
+advances with delay(1) while it waits.
+*/
+
+#include <Adafruit_Fingerprint.h>
+#include "fp_emulator.h"
+#include "fp_slots.h"
+
+#define FP_EMU_DEFAULT_CAPACITY 200      // R503
+#define FP_EMU_SCORE 120                 // Confidence reported for a match
+
+FingerprintEmulator sensorEmulator;
+
+FingerprintEmulator::FingerprintEmulator() { reset(); }
+
+void FingerprintEmulator::reset() {
+  rxLen = txLen = txPos = 0;
+  txReadyAt = 0;
+  pendingLatency = 0;
+  finger = image = model = 0;
+  charBuffer[0] = charBuffer[1] = 0;
+  memset(library, 0, sizeof(library));
+  capacity = FP_EMU_DEFAULT_CAPACITY;
+  baud = 57600;
+  memset(latency, 0, sizeof(latency));
+  latency[FINGERPRINT_GETIMAGE] = 50;    // Image capture
+  latency[FINGERPRINT_IMAGE2TZ] = 60;    // Feature extraction
+  latency[FINGERPRINT_REGMODEL] = 40;    // Template merge
+  latency[FINGERPRINT_STORE] = 30;       // Flash write
+  latency[FINGERPRINT_DELETE] = 30;      // Flash erase
+  searchUs = 500;                        // 1:N search, per library page
+  fastSearchUs = 100;                    // High-speed search, per library page
+  errorInstruction = errorCode = 0;
+  errorTimes = 0;
+  drops = 0;
+  memset(commands, 0, sizeof(commands));
+  busy = 0;
+}
+
+void FingerprintEmulator::placeFinger(uint16_t identity) { finger = identity; }
+void FingerprintEmulator::liftFinger() { finger = 0; }
+
+void FingerprintEmulator::setCapacity(uint16_t c) { capacity = c > FP_EMU_MAX_CAPACITY ? FP_EMU_MAX_CAPACITY : c; }
+void FingerprintEmulator::setBaudRate(uint32_t b) { baud = b; }
+void FingerprintEmulator::setLatency(uint8_t instruction, uint32_t ms) { latency[instruction] = ms; }
+
+void FingerprintEmulator::setSearchCostUs(uint32_t normalUs, uint32_t fastUs) {
+  searchUs = normalUs;
+  fastSearchUs = fastUs;
+}
+
+void FingerprintEmulator::injectError(uint8_t instruction, uint8_t code, uint16_t times) {
+  errorInstruction = instruction;
+  errorCode = code;
+  errorTimes = times;
+}
+
+void FingerprintEmulator::dropResponses(uint16_t count) { drops = count; }
+
+bool FingerprintEmulator::storeTemplate(uint16_t id, uint16_t identity) {
+  if (id >= capacity) return false;
+  library[id] = identity;
+  return true;
+}
+
+uint16_t FingerprintEmulator::templateAt(uint16_t id) const { return id < capacity ? library[id] : 0; }
+
+uint16_t FingerprintEmulator::templateCount() const {
+  uint16_t n = 0;
+  for (uint16_t i = 0; i < capacity; i++) n += library[i] != 0;
+  return n;
+}
+
+uint32_t FingerprintEmulator::commandCount(uint8_t instruction) const { return commands[instruction]; }
+
+uint32_t FingerprintEmulator::totalCommands() const {
+  uint32_t n = 0;
+  for (int i = 0; i < 256; i++) n += commands[i];
+  return n;
+}
+
+uint32_t FingerprintEmulator::wireMs(uint32_t bytes) const {
+  return (bytes * 10 * 1000 + baud - 1) / baud;  // 8N1: 10 bits per byte, rounded up
+}
+
+int FingerprintEmulator::available() {
+  if (txPos >= txLen || millis() < txReadyAt) return 0;  // Still processing or on the wire
+  return txLen - txPos;
+}
+
+int FingerprintEmulator::read() {
+  if (!available()) return -1;
+  return tx[txPos++];
+}
+
+int FingerprintEmulator::peek() {
+  if (!available()) return -1;
+  return tx[txPos];
+}
+
+size_t FingerprintEmulator::write(uint8_t b) {
+  if (rxLen == 0 && b != (FINGERPRINT_STARTCODE >> 8)) return 1;        // Wait for a start code
+  if (rxLen == 1 && b != (FINGERPRINT_STARTCODE & 0xFF)) { rxLen = 0; return 1; }
+  if (rxLen >= sizeof(rx)) { rxLen = 0; return 1; }                       // Oversized, resynchronise
+  rx[rxLen++] = b;
+
+  if (rxLen >= 9) {
+    uint16_t len = ((uint16_t)rx[7] << 8) | rx[8];  // Payload + checksum
+    if (len > FP_EMU_PACKET_MAX + 2) { rxLen = 0; return 1; }
+    if (rxLen == 9 + len) {
+      process();
+      rxLen = 0;
+    }
+  }
+  return 1;
+}
+
+void FingerprintEmulator::respond(uint8_t code, const uint8_t *data, uint16_t len) {
+  uint16_t length = len + 3;  // Confirmation code + data + checksum
+  txLen = 0;
+  txPos = 0;
+  tx[txLen++] = FINGERPRINT_STARTCODE >> 8;
+  tx[txLen++] = FINGERPRINT_STARTCODE & 0xFF;
+  for (int i = 2; i < 6; i++) tx[txLen++] = rx[i];  // Echo the address
+  tx[txLen++] = FINGERPRINT_ACKPACKET;
+  tx[txLen++] = length >> 8;
+  tx[txLen++] = length & 0xFF;
+  tx[txLen++] = code;
+  if (len) memcpy(&tx[txLen], data, len);
+  txLen += len;
+
+  uint16_t sum = FINGERPRINT_ACKPACKET + (length >> 8) + (length & 0xFF) + code;
+  for (uint16_t i = 0; i < len; i++) sum += data[i];
+  tx[txLen++] = sum >> 8;
+  tx[txLen++] = sum & 0xFF;
+
+  uint32_t cost = pendingLatency + wireMs(rxLen + txLen);  // Processing plus both directions on the wire
+  busy += cost;
+  txReadyAt = millis() + cost;
+}
+
+uint16_t FingerprintEmulator::search(uint8_t slot, uint16_t start, uint16_t count, uint32_t perPageUs,
+                                     uint16_t *pagesScanned) {
+  uint16_t wanted = charBuffer[slot == 2 ? 1 : 0];
+  uint16_t end = start + count > capacity ? capacity : start + count;
+  uint16_t id = 0xFFFF;
+  uint16_t scanned = 0;
+  for (uint16_t i = start; i < end; i++) {
+    scanned++;
+    if (wanted && library[i] == wanted) {
+      id = i;
+      break;
+    }
+  }
+  *pagesScanned = scanned;
+  pendingLatency += (scanned * perPageUs + 999) / 1000;
+  return id;
+}
+
+void FingerprintEmulator::process() {
+  uint8_t pid = rx[6];
+  uint16_t len = ((uint16_t)rx[7] << 8) | rx[8];
+  const uint8_t *payload = &rx[9];
+  uint16_t payloadLen = len - 2;
+
+  // Verify the checksum before acting on the command
+  uint16_t sum = pid + rx[7] + rx[8];
+  for (uint16_t i = 0; i < payloadLen; i++) sum += payload[i];
+  uint16_t expected = ((uint16_t)payload[payloadLen] << 8) | payload[payloadLen + 1];
+  if (pid != FINGERPRINT_COMMANDPACKET || payloadLen == 0 || sum != expected) {
+    pendingLatency = 0;
+    respond(FINGERPRINT_PACKETRECIEVEERR);
+    return;
+  }
+
+  uint8_t instruction = payload[0];
+  commands[instruction]++;
+  pendingLatency = latency[instruction];
+
+  if (drops) {  // Simulated lost response
+    drops--;
+    txLen = txPos = 0;
+    return;
+  }
+  if (errorTimes && errorInstruction == instruction) {  // Injected failure
+    errorTimes--;
+    respond(errorCode);
+    return;
+  }
+
+  uint8_t data[32];
+  switch (instruction) {
+    case FINGERPRINT_VERIFYPASSWORD:
+      respond(FINGERPRINT_OK);
+      break;
+
+    case FINGERPRINT_GETIMAGE:
+      image = finger;
+      respond(finger ? FINGERPRINT_OK : FINGERPRINT_NOFINGER);
+      break;
+
+    case FINGERPRINT_IMAGE2TZ: {
+      uint8_t slot = payloadLen > 1 ? payload[1] : 1;
+      if (!image) {
+        respond(FINGERPRINT_INVALIDIMAGE);
+        break;
+      }
+      charBuffer[slot == 2 ? 1 : 0] = image;
+      respond(FINGERPRINT_OK);
+      break;
+    }
+
+    case FINGERPRINT_REGMODEL:
+      if (!charBuffer[0] || charBuffer[0] != charBuffer[1]) {
+        respond(FINGERPRINT_ENROLLMISMATCH);
+        break;
+      }
+      model = charBuffer[0];
+      charBuffer[1] = model;  // The module leaves the merged template in both buffers
+      respond(FINGERPRINT_OK);
+      break;
+
+    case FINGERPRINT_STORE: {
+      uint16_t id = ((uint16_t)payload[2] << 8) | payload[3];
+      uint8_t slot = payload[1];
+      uint16_t identity = model ? model : charBuffer[slot == 2 ? 1 : 0];
+      if (id >= capacity) {
+        respond(FINGERPRINT_BADLOCATION);
+        break;
+      }
+      library[id] = identity;
+      respond(FINGERPRINT_OK);
+      break;
+    }
+
+    case FINGERPRINT_DELETE: {
+      uint16_t id = ((uint16_t)payload[1] << 8) | payload[2];
+      uint16_t n = ((uint16_t)payload[3] << 8) | payload[4];
+      if (id >= capacity || id + n > capacity) {
+        respond(FINGERPRINT_BADLOCATION);
+        break;
+      }
+      for (uint16_t i = 0; i < n; i++) library[id + i] = 0;
+      respond(FINGERPRINT_OK);
+      break;
+    }
+
+    case FINGERPRINT_EMPTY:
+      memset(library, 0, sizeof(library));
+      respond(FINGERPRINT_OK);
+      break;
+
+    case FINGERPRINT_SEARCH:
+    case FINGERPRINT_HISPEEDSEARCH: {
+      uint16_t start = ((uint16_t)payload[2] << 8) | payload[3];
+      uint16_t count = ((uint16_t)payload[4] << 8) | payload[5];
+      uint32_t perPageUs = instruction == FINGERPRINT_HISPEEDSEARCH ? fastSearchUs : searchUs;
+      uint16_t scanned;
+      uint16_t id = search(payload[1], start, count, perPageUs, &scanned);
+      if (id == 0xFFFF) {
+        respond(FINGERPRINT_NOTFOUND);
+        break;
+      }
+      data[0] = id >> 8;
+      data[1] = id & 0xFF;
+      data[2] = FP_EMU_SCORE >> 8;
+      data[3] = FP_EMU_SCORE & 0xFF;
+      respond(FINGERPRINT_OK, data, 4);
+      break;
+    }
+
+    case FINGERPRINT_TEMPLATECOUNT: {
+      uint16_t n = templateCount();
+      data[0] = n >> 8;
+      data[1] = n & 0xFF;
+      respond(FINGERPRINT_OK, data, 2);
+      break;
+    }
+
+    case FINGERPRINT_READINDEX: {
+      // One bit per template, bit 0 of byte 0 is the first ID of the page
+      uint16_t first = payload[1] * 256;
+      memset(data, 0, sizeof(data));
+      for (uint16_t i = 0; i < 256 && first + i < capacity; i++) {
+        if (library[first + i]) data[i / 8] |= 1 << (i % 8);
+      }
+      respond(FINGERPRINT_OK, data, 32);
+      break;
+    }
+
+    case FINGERPRINT_READSYSPARAM:
+      // Status (2), system id (2), capacity (2), security level (2), address (4), packet length (2), baud (2)
+      memset(data, 0, sizeof(data));
+      data[4] = capacity >> 8;          // Library size
+      data[5] = capacity & 0xFF;
+      data[7] = 3;                      // Security level
+      data[8] = data[9] = data[10] = data[11] = 0xFF; // Default address FFFFFFFF
+      data[13] = 2;                     // Packet length code: 128 bytes
+      data[15] = baud / 9600;           // Baud rate as N x 9600
+      respond(FINGERPRINT_OK, data, 16);
+      break;
+
+    case FINGERPRINT_WRITE_REG:
+      if (payload[1] == FINGERPRINT_BAUD_REG_ADDR) baud = payload[2] * 9600;
+      respond(FINGERPRINT_OK);
+      break;
+
+    default:  // LED control and other commands without an effect here
+      respond(FINGERPRINT_OK);
+      break;
+  }
+}
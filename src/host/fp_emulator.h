@@ -0,0 +1,84 @@
+/*
+Description: Software emulator of the R30x/R503 fingerprint sensor protocol for the native build. It speaks the
+same framed packets as the real module over a Stream, so the unmodified Adafruit_Fingerprint library (and with it
+getFingerprintID(), the enrollment state machine and the fingerprint service) runs against it on Linux.
+Fingers are simulated as integer identities; command latency, UART wire time and errors can be configured.
+*/
+
+#ifndef FP_EMULATOR_H
+#define FP_EMULATOR_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#define FP_EMU_MAX_CAPACITY 3000   // Largest library the emulator can hold (large-site modules)
+#define FP_EMU_PACKET_MAX 64       // Largest payload of a command packet
+
+class FingerprintEmulator : public Stream {
+ public:
+  FingerprintEmulator();
+
+  // Stream interface used by Adafruit_Fingerprint
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t b) override;
+  using Stream::write;
+
+  // Simulated user
+  void placeFinger(uint16_t identity);  // Put a finger with this identity (> 0) on the sensor
+  void liftFinger();                    // Remove the finger
+  bool fingerPresent() const { return finger != 0; }
+
+  // Module configuration
+  void reset();                                        // Empty library, defaults, no pending errors
+  void setCapacity(uint16_t capacity);                 // Library size reported by getParameters()
+  void setBaudRate(uint32_t baud);                     // Rate used for the wire time model
+  void setLatency(uint8_t instruction, uint32_t ms);   // Processing time of a command
+  void setSearchCostUs(uint32_t normalUs, uint32_t fastUs); // Per-page cost of search (0x04) / high-speed search (0x1B)
+  void injectError(uint8_t instruction, uint8_t code, uint16_t times = 1); // Answer the next commands with code
+  void dropResponses(uint16_t count);                  // Do not answer the next commands (host times out)
+
+  // Library access for tests
+  bool storeTemplate(uint16_t id, uint16_t identity);  // Put a template directly into the library
+  uint16_t templateAt(uint16_t id) const;              // Identity stored at id, 0 if empty
+  uint16_t templateCount() const;
+
+  // Statistics
+  uint32_t commandCount(uint8_t instruction) const;    // Commands of one kind since reset()
+  uint32_t totalCommands() const;
+  uint32_t busyMs() const { return busy; }             // Virtual time spent in processing and on the wire
+
+ private:
+  void process();                                      // Handle one complete command packet
+  void respond(uint8_t code, const uint8_t *data = NULL, uint16_t len = 0); // Queue an acknowledge packet
+  uint32_t wireMs(uint32_t bytes) const;               // UART time for a number of bytes
+  uint16_t search(uint8_t slot, uint16_t start, uint16_t count, uint32_t perPageUs, uint16_t *pagesScanned);
+
+  uint8_t rx[FP_EMU_PACKET_MAX + 16];   // Command packet being received
+  uint16_t rxLen;
+  uint8_t tx[FP_EMU_PACKET_MAX + 16];   // Response being sent
+  uint16_t txLen, txPos;
+  uint32_t txReadyAt;                   // millis() when the response becomes readable
+  uint32_t pendingLatency;              // Processing time of the current command
+
+  uint16_t finger;                      // Identity of the finger on the sensor, 0 if none
+  uint16_t image;                       // Identity in the image buffer, 0 if none
+  uint16_t charBuffer[2];               // Identities in character buffers 1 and 2
+  uint16_t model;                       // Identity of the merged model, 0 if none
+  uint16_t library[FP_EMU_MAX_CAPACITY]; // Stored templates, 0 = empty
+
+  uint16_t capacity;
+  uint32_t baud;
+  uint32_t latency[256];                // Per instruction processing time in ms
+  uint32_t searchUs, fastSearchUs;      // Per page search cost
+  uint8_t errorInstruction, errorCode;  // Injected error
+  uint16_t errorTimes;
+  uint16_t drops;                       // Responses still to drop
+  uint32_t commands[256];               // Per instruction command count
+  uint32_t busy;                        // Accumulated virtual busy time
+};
+
+extern FingerprintEmulator sensorEmulator;  // Instance the host build's `finger` talks to
+
+#endif // FP_EMULATOR_H
@@ -0,0 +1,30 @@
+/*
+Description: Implementation of the Arduino API shim (virtual clock and stdout Serial) for the native build.
+*/
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+static uint32_t clockMs = 0;  // Virtual time in milliseconds
+
+HostSerial Serial;  // Debug output on stdout
+
+uint32_t millis(void) { return clockMs; }
+uint32_t micros(void) { return clockMs * 1000; }
+void delay(uint32_t ms) { clockMs += ms; }
+void host_clock_advance(uint32_t ms) { clockMs += ms; }
+void yield(void) {}
+
+size_t HostSerial::print(const char *s) { return fputs(s, stdout) < 0 ? 0 : strlen(s); }
+size_t HostSerial::print(long v) { return ::printf("%ld", v); }
+size_t HostSerial::println(const char *s) { return ::printf("%s\n", s); }
+size_t HostSerial::println(long v) { return ::printf("%ld\n", v); }
+
+int HostSerial::printf(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int n = vprintf(fmt, args);  // Forward to the C library
+  va_end(args);
+  return n;
+}
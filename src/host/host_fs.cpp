@@ -0,0 +1,102 @@
+/*
+Description: Implementation of the file system shim of the native build on top of stdio and std::filesystem.
+Mode strings are the ESP32 core's ("r", "w", "a", "r+", "w+", "a+"); files are opened in binary mode.
+*/
+
+#include <string>
+#include <filesystem>
+#include "FS.h"
+#include "SPIFFS.h"
+
+#define HOST_FS_TOTAL_BYTES 1441792  // Default SPIFFS partition of a 4 MB ESP32
+
+fs::FS SPIFFS;
+
+static std::string root = "host_fs";  // Host directory holding the files
+
+void host_fs_set_root(const char *dir) { root = dir; }
+
+/* Host path of a file system path ("/users.dat" -> "<root>/users.dat") */
+static std::string host_path(const char *path) {
+  return root + (path[0] == '/' ? "" : "/") + path;
+}
+
+namespace fs {
+
+size_t File::write(const uint8_t *buf, size_t size) { return fp ? fwrite(buf, 1, size, fp) : 0; }
+size_t File::read(uint8_t *buf, size_t size) { return fp ? fread(buf, 1, size, fp) : 0; }
+
+int File::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+int File::available() { return fp ? (int)(size() - position()) : 0; }
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  int whence = mode == SeekSet ? SEEK_SET : mode == SeekCur ? SEEK_CUR : SEEK_END;
+  return fp && fseek(fp, pos, whence) == 0;
+}
+
+size_t File::position() const { return fp ? ftell(fp) : 0; }
+
+size_t File::size() const {
+  if (!fp) return 0;
+  long pos = ftell(fp);
+  fseek(fp, 0, SEEK_END);
+  long end = ftell(fp);
+  fseek(fp, pos, SEEK_SET);
+  return end;
+}
+
+void File::flush() {
+  if (fp) fflush(fp);
+}
+
+void File::close() {
+  if (fp) fclose(fp);
+  fp = NULL;
+}
+
+bool FS::begin(bool formatOnFail) {
+  (void)formatOnFail;
+  std::error_code ec;
+  std::filesystem::create_directories(root, ec);
+  return std::filesystem::is_directory(root, ec);
+}
+
+bool FS::format() {
+  std::error_code ec;
+  std::filesystem::remove_all(root, ec);
+  return begin();
+}
+
+File FS::open(const char *path, const char *mode) {
+  std::string m = mode;
+  if (m.find('b') == std::string::npos) m += 'b';
+  return File(fopen(host_path(path).c_str(), m.c_str()));
+}
+
+bool FS::exists(const char *path) {
+  std::error_code ec;
+  return std::filesystem::exists(host_path(path), ec);
+}
+
+bool FS::remove(const char *path) { return ::remove(host_path(path).c_str()) == 0; }
+
+bool FS::rename(const char *from, const char *to) {
+  return ::rename(host_path(from).c_str(), host_path(to).c_str()) == 0;
+}
+
+size_t FS::totalBytes() { return HOST_FS_TOTAL_BYTES; }
+
+size_t FS::usedBytes() {
+  std::error_code ec;
+  size_t used = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(root, ec)) {
+    if (entry.is_regular_file(ec)) used += entry.file_size(ec);
+  }
+  return used;
+}
+
+}  // namespace fs
@@ -0,0 +1,110 @@
+/*
+Description: Memory framebuffer display driver and scripted pointer driver for the native build.
+*/
+
+#include <Arduino.h>
+#include "host_hal.h"
+#include "fp_service.h"
+#include "access_log.h"
+#include "ui.h"
+#include "serial_log.h"
+#include "trace.h"
+#include "draw_buf.h"
+
+#define HOST_TICK_MS 5         // Virtual time per main loop iteration (matches delay(5) on the device)
+#define HOST_TAP_MS 60         // Press and release duration of host_tap()
+
+static lv_color_t framebuffer[HOST_SCREEN_WIDTH * HOST_SCREEN_HEIGHT]; // Rendered screen contents
+static lv_disp_draw_buf_t draw_buf;                                    // LVGL draw buffer descriptor (src/draw_buf.cpp)
+static lv_disp_drv_t disp_drv;                                         // Framebuffer display driver
+static lv_indev_drv_t indev_drv;                                       // Scripted pointer driver
+static lv_disp_t *disp;                                                // Registered display
+
+static const host_touch_step_t *script = NULL; // Touch script being played
+static size_t scriptLength = 0;                // Number of steps in the script
+static size_t scriptStep = 0;                  // Current step
+static uint32_t stepStart = 0;                 // Virtual time the current step started
+static host_touch_step_t lastTouch = {0, 0, false, 0}; // Last reported state, held after the script ends
+
+/* Copy the rendered area into the framebuffer (replaces my_disp_flush) */
+static void host_disp_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+  TRACE_BEGIN(TRACE_FLUSH, 0);
+  uint32_t w = (area->x2 - area->x1 + 1); // Width of the area to update
+  for (int32_t y = area->y1; y <= area->y2; y++) {
+    memcpy(&framebuffer[y * HOST_SCREEN_WIDTH + area->x1], color_p, w * sizeof(lv_color_t)); // Copy one row
+    color_p += w;
+  }
+  TRACE_END(TRACE_FLUSH, 0);
+  lv_disp_flush_ready(drv); // Copy is synchronous
+}
+
+/* Report the current step of the touch script (replaces lvgl_port_tp_read) */
+static void host_pointer_read(lv_indev_drv_t *drv, lv_indev_data_t *data) {
+  // Move to the next step once the current one has lasted long enough
+  while (script && scriptStep < scriptLength && millis() - stepStart >= script[scriptStep].duration_ms) {
+    stepStart += script[scriptStep].duration_ms;
+    scriptStep++;
+  }
+  if (script && scriptStep < scriptLength) {
+    lastTouch = script[scriptStep];   // Report the active step
+  } else {
+    script = NULL;                    // Script finished, stay released
+    lastTouch.pressed = false;
+  }
+
+  data->state = lastTouch.pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+  data->point.x = lastTouch.x;
+  data->point.y = lastTouch.y;
+}
+
+void host_hal_init() {
+  lv_init();
+  draw_buf_begin(&draw_buf, HOST_SCREEN_WIDTH, HOST_SCREEN_HEIGHT, DRAW_BUF_LINES);  // Same height as on the device
+
+  lv_disp_drv_init(&disp_drv);
+  disp_drv.flush_cb = host_disp_flush;
+  disp_drv.draw_buf = &draw_buf;
+  disp_drv.hor_res = HOST_SCREEN_WIDTH;
+  disp_drv.ver_res = HOST_SCREEN_HEIGHT;
+  disp = lv_disp_drv_register(&disp_drv);
+
+  lv_indev_drv_init(&indev_drv);
+  indev_drv.type = LV_INDEV_TYPE_POINTER;
+  indev_drv.read_cb = host_pointer_read;
+  lv_indev_drv_register(&indev_drv);
+}
+
+lv_disp_t *host_display() { return disp; }
+
+const lv_color_t *host_framebuffer() { return framebuffer; }
+
+void host_pointer_play(const host_touch_step_t *steps, size_t count) {
+  script = steps;
+  scriptLength = count;
+  scriptStep = 0;
+  stepStart = millis();
+}
+
+bool host_pointer_busy() { return script != NULL; }
+
+void host_run(uint32_t ms) {
+  for (uint32_t t = 0; t < ms; t += HOST_TICK_MS) {
+    TRACE_BEGIN(TRACE_LVGL, 0);
+    lv_timer_handler();             // Same as loop() on the device
+    TRACE_END(TRACE_LVGL, 0);
+    fingerprint_poll();
+    access_log_set_quiet(scanningMode || enrollingMode);
+    access_log_poll();              // The log writer task on the device
+    serial_log_drain();             // The log task on the device
+    host_clock_advance(HOST_TICK_MS);
+  }
+}
+
+void host_tap(int16_t x, int16_t y) {
+  static host_touch_step_t tap[2];
+  tap[0] = {x, y, true, HOST_TAP_MS};   // Press
+  tap[1] = {x, y, false, HOST_TAP_MS};  // Release
+  host_pointer_play(tap, 2);
+  while (host_pointer_busy()) host_run(HOST_TICK_MS);
+  host_run(100);                        // Let the click event and redraw settle
+}
@@ -0,0 +1,33 @@
+/*
+Description: Host replacements for the device drivers. A memory framebuffer display driver stands in for
+my_disp_flush and a scripted pointer driver stands in for lvgl_port_tp_read, so the UI runs headless on Linux.
+*/
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <lvgl.h>
+
+// Screen resolution, same as the device panel
+#define HOST_SCREEN_WIDTH 320
+#define HOST_SCREEN_HEIGHT 240
+
+// One step of a scripted touch sequence
+struct host_touch_step_t {
+  int16_t x;              // Touch X coordinate
+  int16_t y;              // Touch Y coordinate
+  bool pressed;           // True while the screen is touched
+  uint32_t duration_ms;   // How long this step lasts
+};
+
+void host_hal_init();                                               // lv_init() and register the host drivers
+lv_disp_t *host_display();                                          // The framebuffer display
+const lv_color_t *host_framebuffer();                               // Rendered pixels, HOST_SCREEN_WIDTH per row
+void host_pointer_play(const host_touch_step_t *steps, size_t count); // Start a touch script
+bool host_pointer_busy();                                           // True until the script has finished
+void host_run(uint32_t ms);                                         // Run loop() (LVGL + fingerprint_poll) for ms of virtual time
+void host_tap(int16_t x, int16_t y);                                // Press and release at (x, y), then settle
+
+#endif // HOST_HAL_H
@@ -0,0 +1,218 @@
+/*
+Description: Entry point of the native (host) build. Builds the same UI as setup() on the device against the
+framebuffer display and scripted pointer drivers and the sensor emulator, then walks through the main menu,
+scanning, ID entry and enrollment and checks that the UI ends up in the expected state. Exits non-zero on any
+mismatch. Not built for `pio test`, which provides its own main().
+*/
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <Adafruit_Fingerprint.h>
+#include "host_hal.h"
+#include "fp_emulator.h"
+#include "fp_service.h"
+#include "fp_slots.h"
+#include "user_dir.h"
+#include "access_log.h"
+#include "serial_log.h"
+#include "trace.h"
+#include <SPIFFS.h>
+#include "ui.h"
+#include "ui_nav.h"
+#include "id_keypad.h"
+#include "ui_bench.h"
+#include "search_bench.h"
+#include "status_label.h"
+#include "mem_monitor.h"
+#include "draw_buf.h"
+
+#ifndef PIO_UNIT_TESTING
+
+extern Adafruit_Fingerprint finger;  // Talks to sensorEmulator (host_sensor.cpp)
+
+#define ENROLLED_FINGER 42  // Identity of the simulated user
+
+// Button centres in screen coordinates (screen centre 160,120 plus the offsets used in ui_create)
+#define SCAN_X 80      // Scan button, main menu
+#define ENROLL_X 240   // Enroll button
+#define CENTER_X 160   // Return button of the scanning and enrolling screens
+#define BUTTON_Y 160   // All buttons sit 40px below the centre
+
+static int failures = 0;  // Number of failed checks
+
+/* Sensor handshake, run by the service on the first fp_service_receive() as the task does on the device */
+static bool sensor_connect() {
+  return finger.verifyPassword() && finger.getParameters() == FINGERPRINT_OK && fp_slots_begin() == FINGERPRINT_OK;
+}
+
+/* Record a failed expectation */
+static void check(bool ok, const char *what) {
+  printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+  if (!ok) failures++;
+}
+
+/* Tap the centre of one key of a button matrix (keypad or keyboard) */
+static void tap_key(lv_obj_t *matrix, uint16_t key) {
+  const lv_area_t *area = &((lv_btnmatrix_t *)matrix)->button_areas[key];  // Relative to the widget
+  host_tap(matrix->coords.x1 + (area->x1 + area->x2) / 2, matrix->coords.y1 + (area->y1 + area->y2) / 2);
+}
+
+/* True if the status label shows this text */
+static bool status_is(const char *text) {
+  return strcmp(lv_label_get_text(fingerLabel), text) == 0;
+}
+
+/* True if the widget is currently shown (built, on the loaded screen and not hidden) */
+static bool visible(lv_obj_t *obj) {
+  return obj && lv_obj_get_screen(obj) == lv_scr_act() && !lv_obj_has_flag(obj, LV_OBJ_FLAG_HIDDEN);
+}
+
+int main() {
+  serial_log_begin();
+  SPIFFS.format();  // Start from an empty file system (host_fs/ in the working directory)
+  user_dir_begin();
+  access_log_begin();
+  host_hal_init();  // Framebuffer display and scripted pointer
+  ui_create();      // Same widgets as setup() on the device
+  check(idKeypad == NULL && keyboard == NULL, "boot: ID and name entry widgets not built yet");
+  fp_service_begin(sensor_connect);  // Handshake in the background, as on the device
+  status_show(STATUS_CONNECTING);
+  lv_event_send(enrollButton, LV_EVENT_CLICKED, NULL);  // Before the first loop iteration: handshake still pending
+  check(status_is("Connecting to the sensor...") && idKeypad == NULL, "boot: Enroll refused during the handshake");
+  host_run(100);    // Render the main menu
+  check(fp_sensor_state() == FP_SENSOR_READY && status_is("Select Enroll or Scan."), "boot: handshake reported");
+
+#ifdef UI_BENCH
+  // Benchmark build: measure every UI state against the framebuffer driver instead of the checks below
+  static ui_bench_result_t benchResults[UI_BENCH_STATE_COUNT];
+  ui_bench_run(host_display(), benchResults);
+  ui_bench_print(benchResults);
+  return 0;
+#endif
+#ifdef SEARCH_BENCH
+  // Search strategy benchmark against an emulated library filled through enrollment
+  search_bench_run();
+  return 0;
+#endif
+
+  check(!scanningMode && !enrollingMode, "main menu: no mode active");
+  check(visible(scanButton) && visible(enrollButton) && !visible(returnButton), "main menu: Scan and Enroll shown");
+
+  host_tap(SCAN_X, BUTTON_Y);  // Start scanning
+  check(scanningMode, "scan: scanning mode on");
+  check(ui_nav_current() == UI_SCREEN_SCAN && !visible(enrollButton) && visible(fingerLabel), "scan: scanning screen");
+  check(ui_nav_transition_px() < HOST_SCREEN_WIDTH * HOST_SCREEN_HEIGHT / 2,
+        "scan: transition redraws only the buttons");
+
+  host_run(200);
+  check(status_is("No Finger Detected"), "scan: no finger reported");
+  status_reset_counters();  // Idle reader: the same result arrives over and over
+  host_run(500);
+  check(status_update_count() == 0 && status_skip_count() > 0, "scan: idle reader does not redraw the label");
+
+  host_tap(CENTER_X, BUTTON_Y);  // Return button of the scanning screen
+  check(!scanningMode && visible(enrollButton), "scan: back to main menu");
+
+  host_tap(ENROLL_X, BUTTON_Y);  // Open ID entry
+  check(visible(idKeypad) && !visible(keyboard), "enroll: ID keypad shown");
+  check(!visible(scanButton) && !visible(enrollButton), "enroll: menu buttons hidden");
+  check(id_keypad_get_value() == 1, "enroll: lowest free ID suggested");
+
+  tap_key(idKeypad, ID_KEYPAD_BACKSPACE);  // Type the ID on the keypad
+  tap_key(idKeypad, 4);                    // "5"
+  check(id_keypad_get_value() == 5, "enroll: ID typed on the keypad");
+  id_keypad_set_value(0);
+  for (int i = 0; i < 6; i++) tap_key(idKeypad, 8);  // "9" until the capacity stops it
+  check(id_keypad_get_value() < fp_slots_capacity() && id_keypad_get_value() > 9, "enroll: keypad stops at the capacity");
+  id_keypad_set_value(5);
+  tap_key(idKeypad, ID_KEYPAD_OK);
+  check(status_is("Name for ID #5:") && visible(keyboard), "enroll: asks for the name");
+  lv_textarea_set_text(inputTextArea, "Alice");      // Type the name
+  lv_event_send(keyboard, LV_EVENT_READY, NULL);
+  host_run(100);
+  check(enrollingMode && id == 5, "enroll: enrolling ID 5");
+  check(!visible(keyboard) && !visible(idKeypad) && visible(returnButton), "enroll: keyboard hidden, Return shown");
+
+  host_run(200);
+  check(status_is("Place finger to enroll as ID #5"), "enroll: asks for the finger");
+  sensorEmulator.placeFinger(ENROLLED_FINGER);
+  host_run(500);
+  check(status_is("Remove finger and place it again."), "enroll: first image taken");
+  sensorEmulator.liftFinger();
+  host_run(300);
+  check(status_is("Place the same finger again."), "enroll: finger lifted");
+  sensorEmulator.placeFinger(ENROLLED_FINGER);
+  host_run(500);
+  sensorEmulator.liftFinger();
+  check(sensorEmulator.templateAt(5) == ENROLLED_FINGER, "enroll: template stored as ID 5");
+  check(status_is("Fingerprint enrolled successfully as ID #5") && ui_nav_current() == UI_SCREEN_RESULT,
+        "enroll: success shown");
+  host_run(2500);
+  check(!enrollingMode && visible(scanButton) && visible(enrollButton), "enroll: back to main menu");
+
+  host_tap(SCAN_X, BUTTON_Y);  // Scan the enrolled finger
+  sensorEmulator.placeFinger(ENROLLED_FINGER);
+  host_run(500);
+  check(status_is("Welcome, Alice (ID #5)"), "scan: enrolled finger matched by name");
+  sensorEmulator.placeFinger(ENROLLED_FINGER + 1);
+  host_run(500);
+  check(status_is("No Match Found"), "scan: unknown finger rejected");
+  sensorEmulator.liftFinger();
+  host_tap(CENTER_X, BUTTON_Y);
+
+  access_record_t events[2];
+  access_log_flush();
+  check(access_log_pending() == 0 && access_log_recent(events, 2) == 2 && events[0].code == FINGERPRINT_NOTFOUND &&
+        access_log_begin() && access_log_recent(events, 1) == 1 && events[0].code == FINGERPRINT_NOTFOUND,
+        "access log: scans written to flash and read back after a restart");
+
+  host_tap(ENROLL_X, BUTTON_Y);  // Try to overwrite ID 5
+  id_keypad_set_value(5);
+  lv_event_send(idKeypad, LV_EVENT_READY, NULL);
+  check(status_is("ID #5 is already in use.") && visible(idKeypad), "enroll: taken ID refused");
+
+  id = 5;  // Taken after the keypad accepted it: the service refuses and the keypad comes back
+  ui_nav_go(UI_SCREEN_NAME_ENTRY);
+  lv_event_send(keyboard, LV_EVENT_READY, NULL);
+  host_run(200);
+  check(!enrollingMode && ui_nav_current() == UI_SCREEN_ID_ENTRY && status_is("ID #5 is already in use.") &&
+        sensorEmulator.templateAt(5) == ENROLLED_FINGER, "enroll: ID refused by the service, back to the keypad");
+
+  id_keypad_set_value(6);  // Start another enrollment and cancel it
+  lv_event_send(idKeypad, LV_EVENT_READY, NULL);
+  lv_event_send(keyboard, LV_EVENT_READY, NULL);  // No name
+  host_run(200);
+  host_tap(CENTER_X, BUTTON_Y);  // Return button
+  sensorEmulator.placeFinger(ENROLLED_FINGER);
+  host_run(1500);
+  sensorEmulator.liftFinger();
+  check(!enrollingMode && sensorEmulator.templateAt(6) == 0, "enroll: Return cancels the enrollment");
+
+  static lv_color_t before[HOST_SCREEN_WIDTH * HOST_SCREEN_HEIGHT];  // Same picture with every buffer height
+  uint16_t lines = draw_buf_lines();
+  memcpy(before, host_framebuffer(), sizeof(before));
+  bool same = true;
+  const int16_t heights[] = {DRAW_BUF_HALF, DRAW_BUF_FULL, 7};
+  for (int16_t height : heights) {
+    draw_buf_set_lines(host_display(), height);
+    lv_refr_now(host_display());
+    same = same && memcmp(before, host_framebuffer(), sizeof(before)) == 0;
+  }
+  check(same && draw_buf_lines() == 7, "display: same picture with half-screen, full-frame and 7-line buffers");
+  draw_buf_set_lines(host_display(), lines);
+
+  mem_stats_t mem;  // Every screen has been built by now
+  mem_stats_read(&mem);
+  check(mem.used > 0 && mem.maxUsed >= mem.used && mem.largestFree <= mem.freeBytes,
+        "memory: LVGL heap figures consistent");
+  mem_monitor_report();
+
+  serial_log_drain();
+#ifdef TRACE_ENABLED
+  trace_dump();  // Last scans and enrollment on the virtual clock, for tools/trace2json.py
+#endif
+  printf("%d failure(s)\n", failures);
+  return failures ? 1 : 0;
+}
+
+#endif // PIO_UNIT_TESTING
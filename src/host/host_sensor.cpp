@@ -0,0 +1,18 @@
+/*
+Description: Fingerprint sensor of the native build. `finger` talks to the protocol emulator instead of
+HardwareSerial mySerial(2), and the touch line is reported as not wired so callers poll getImage().
+*/
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+#include "finger_detect.h"
+#include "fp_emulator.h"
+
+Adafruit_Fingerprint finger = Adafruit_Fingerprint(&sensorEmulator);  // Same name as in main.cpp
+
+// No touch line on the host: presence is always "maybe", so the sensor is asked
+bool finger_detect_begin(int8_t pin) { (void)pin; return false; }
+bool finger_detect_wired() { return false; }
+bool finger_detect_present() { return true; }
+bool finger_detect_wait(uint32_t timeoutMs) { (void)timeoutMs; return true; }
+uint32_t finger_detect_touch_count() { return 0; }
@@ -0,0 +1,132 @@
+/*
+Description: Search strategy benchmark (native build, SEARCH_BENCH). The library is populated the way the device
+populates it, through enroll_start() and handleFingerprintEnrollment() with a simulated finger placed, lifted and
+placed again, so the occupancy bitmap is maintained by the same hooks as on the device. Two layouts are measured:
+IDs 1..N as users usually type them, and IDs spread evenly over the whole library, which splits it into many
+short ranges.
+*/
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <Adafruit_Fingerprint.h>
+#include "enroll.h"
+#include "fp_emulator.h"
+#include "fp_search.h"
+#include "fp_slots.h"
+#include "fp_service.h"
+#include "search_bench.h"
+
+extern Adafruit_Fingerprint finger;  // Talks to sensorEmulator (host_sensor.cpp)
+
+#define SEARCH_BENCH_IDENTITY 1000   // Simulated identity of the first user
+#define SEARCH_BENCH_UNKNOWN 9999    // Finger that is not enrolled
+#define SEARCH_BENCH_NO_MATCH 0xFFFF // Expected ID of the unknown finger
+
+static const uint16_t capacities[] = {200, 1000};  // R503, R307
+static const fp_search_mode_t modes[] = {FP_SEARCH_FULL, FP_SEARCH_FAST, FP_SEARCH_OCCUPIED};
+
+// Cost of one getFingerprintID() call
+struct search_bench_sample_t {
+  uint32_t ms;        // Virtual time from getImage() to the result
+  uint32_t searches;  // Search commands sent
+  bool ok;            // Expected result
+};
+
+/* Enroll one simulated finger through the state machine */
+static bool search_bench_enroll(uint16_t id, uint16_t identity) {
+  enroll_start(id);
+  uint32_t start = millis();
+  while (millis() - start < 2 * ENROLL_FINGER_TIMEOUT_MS) {
+    switch (enroll_state()) {
+      case ENROLL_WAIT_FIRST:
+      case ENROLL_WAIT_SECOND:
+        sensorEmulator.placeFinger(identity);
+        break;
+      case ENROLL_WAIT_REMOVE:
+        sensorEmulator.liftFinger();
+        break;
+      case ENROLL_DONE:
+        sensorEmulator.liftFinger();
+        enroll_cancel();  // Skip the success message hold
+        return true;
+      case ENROLL_FAILED:
+      case ENROLL_TIMED_OUT:
+        enroll_cancel();
+        return false;
+      default:
+        break;
+    }
+    handleFingerprintEnrollment();
+    delay(5);  // One loop() iteration
+  }
+  enroll_cancel();
+  return false;
+}
+
+/* Time one scan of a finger and check the matched ID (SEARCH_BENCH_NO_MATCH for an unknown finger) */
+static search_bench_sample_t search_bench_scan(uint16_t identity, uint16_t expectedId) {
+  uint32_t searches = sensorEmulator.commandCount(FINGERPRINT_SEARCH) +
+                      sensorEmulator.commandCount(FINGERPRINT_HISPEEDSEARCH);
+  sensorEmulator.placeFinger(identity);
+  uint32_t start = millis();
+  uint16_t matchedId = SEARCH_BENCH_NO_MATCH;
+  uint8_t p = getFingerprintID(&matchedId);
+  search_bench_sample_t sample;
+  sample.ms = millis() - start;
+  sample.searches = sensorEmulator.commandCount(FINGERPRINT_SEARCH) +
+                    sensorEmulator.commandCount(FINGERPRINT_HISPEEDSEARCH) - searches;
+  if (expectedId == SEARCH_BENCH_NO_MATCH) {
+    sample.ok = p == FINGERPRINT_NOTFOUND;
+  } else {
+    sample.ok = p == FINGERPRINT_OK && matchedId == expectedId;
+  }
+  sensorEmulator.liftFinger();
+  return sample;
+}
+
+void search_bench_run() {
+  static char table[24][128];  // Printed after the enrollment logs
+  int rows = 0;
+  enroll_set_listener(NULL);  // Nobody drains the service's result queue here
+
+  for (uint16_t capacity : capacities) {
+    for (int spread = 0; spread < 2; spread++) {
+      sensorEmulator.reset();
+      sensorEmulator.setCapacity(capacity);
+      finger.getParameters();
+      fp_slots_begin();  // Empty index table
+
+      uint16_t firstId = 0, lastId = 0;
+      for (uint16_t i = 0; i < SEARCH_BENCH_USERS; i++) {
+        uint16_t id = spread ? i * (capacity / SEARCH_BENCH_USERS) : i + 1;
+        if (!search_bench_enroll(id, SEARCH_BENCH_IDENTITY + i)) {
+          Serial.printf("Enrollment of ID %u failed, benchmark aborted\n", id);
+          return;
+        }
+        if (i == 0) firstId = id;
+        lastId = id;
+      }
+
+      for (fp_search_mode_t mode : modes) {
+        fp_search_set_mode(mode);
+        search_bench_sample_t first = search_bench_scan(SEARCH_BENCH_IDENTITY, firstId);
+        search_bench_sample_t last = search_bench_scan(SEARCH_BENCH_IDENTITY + SEARCH_BENCH_USERS - 1, lastId);
+        search_bench_sample_t unknown = search_bench_scan(SEARCH_BENCH_UNKNOWN, SEARCH_BENCH_NO_MATCH);
+        snprintf(table[rows++], sizeof(table[0]), "%8u %-7s %-16s | %6lu %3lu | %6lu %3lu | %6lu %3lu %s",
+                 capacity, spread ? "spread" : "packed", fp_search_mode_name(mode),
+                 (unsigned long)first.ms, (unsigned long)first.searches,
+                 (unsigned long)last.ms, (unsigned long)last.searches,
+                 (unsigned long)unknown.ms, (unsigned long)unknown.searches,
+                 first.ok && last.ok && unknown.ok ? "" : "WRONG RESULT");
+      }
+    }
+  }
+  fp_search_set_mode(FP_SEARCH_MODE);
+
+  Serial.printf("Search benchmark (%d enrolled fingers, times in ms on the emulator's virtual clock)\n",
+                SEARCH_BENCH_USERS);
+  Serial.printf("%8s %-7s %-16s | %10s | %10s | %10s\n", "capacity", "layout", "strategy",
+                "first", "last", "unknown");
+  Serial.printf("%8s %-7s %-16s | %6s %3s | %6s %3s | %6s %3s\n", "", "", "", "ms", "cmd", "ms", "cmd", "ms", "cmd");
+  for (int i = 0; i < rows; i++) Serial.println(table[i]);
+}
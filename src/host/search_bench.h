@@ -0,0 +1,17 @@
+/*
+Description: Search strategy benchmark of the native build. Fills the emulated library through the enrollment
+state machine, then times getFingerprintID() with every fp_search_mode_t for a match near the start, a match at
+the end and an unknown finger, at several sensor capacities. Times are on the emulator's virtual clock, which
+models command latency, per-page search cost and UART wire time.
+*/
+
+#ifndef SEARCH_BENCH_H
+#define SEARCH_BENCH_H
+
+#ifndef SEARCH_BENCH_USERS
+#define SEARCH_BENCH_USERS 10  // Fingers enrolled per run
+#endif
+
+void search_bench_run();  // Run all capacities and strategies and print a table
+
+#endif // SEARCH_BENCH_H
@@ -0,0 +1,84 @@
+/*
+Description: Numeric ID keypad (see id_keypad.h). Compared with lv_keyboard it has 12 instead of about 40 buttons
+and no text area: the value is a plain label, which has no blinking cursor to redraw.
+*/
+
+#include <Arduino.h>
+#include <lvgl.h>
+#include "id_keypad.h"
+
+static const char *const keyMap[] = {
+  "1", "2", "3", "\n",
+  "4", "5", "6", "\n",
+  "7", "8", "9", "\n",
+  LV_SYMBOL_BACKSPACE, "0", LV_SYMBOL_OK, ""
+};
+
+// Digits and OK act once per press; holding backspace repeats
+#define KEY_ONCE (LV_BTNMATRIX_CTRL_NO_REPEAT)
+static const lv_btnmatrix_ctrl_t keyCtrl[] = {
+  KEY_ONCE, KEY_ONCE, KEY_ONCE,
+  KEY_ONCE, KEY_ONCE, KEY_ONCE,
+  KEY_ONCE, KEY_ONCE, KEY_ONCE,
+  0, KEY_ONCE, KEY_ONCE | LV_BTNMATRIX_CTRL_CLICK_TRIG  // OK on release, as a button click
+};
+
+static lv_obj_t *keypad = NULL;      // Button matrix
+static lv_obj_t *valueLabel = NULL;  // Typed ID
+static uint16_t value = 0;           // Typed ID, 0 while empty
+static uint16_t minId = 1, maxId = 0;
+
+uint16_t id_keypad_apply(uint16_t current, uint16_t key, uint16_t max) {
+  if (key == ID_KEYPAD_BACKSPACE) return current / 10;
+  uint8_t digit = key < ID_KEYPAD_BACKSPACE ? key + 1 : 0;  // Keys 0-8 are 1-9, key 10 is 0
+  uint32_t next = (uint32_t)current * 10 + digit;
+  if (next == 0 || next > max) return current;  // No leading zero, nothing past the capacity
+  return next;
+}
+
+/* Show the typed ID, or the prompt while empty */
+static void show_value() {
+  if (value) lv_label_set_text_fmt(valueLabel, "ID %u", value);
+  else lv_label_set_text(valueLabel, "Enter ID");
+}
+
+static void keypad_event_handler(lv_event_t *e) {
+  if (lv_event_get_code(e) != LV_EVENT_VALUE_CHANGED) return;
+  uint16_t key = lv_btnmatrix_get_selected_btn(keypad);
+  if (key == ID_KEYPAD_OK) {
+    if (value >= minId) lv_event_send(keypad, LV_EVENT_READY, NULL);
+    return;
+  }
+  if (key > ID_KEYPAD_OK) return;  // LV_BTNMATRIX_BTN_NONE
+  uint16_t next = id_keypad_apply(value, key, maxId);
+  if (next == value) return;  // Refused digit: nothing to redraw
+  value = next;
+  show_value();
+}
+
+lv_obj_t *id_keypad_create(lv_obj_t *parent) {
+  valueLabel = lv_label_create(parent);
+  lv_obj_align(valueLabel, LV_ALIGN_CENTER, 0, -15);  // Between the status label and the keys
+
+  keypad = lv_btnmatrix_create(parent);
+  lv_btnmatrix_set_map(keypad, (const char **)keyMap);
+  lv_btnmatrix_set_ctrl_map(keypad, keyCtrl);
+  lv_obj_set_size(keypad, LV_PCT(100), LV_PCT(50));  // Same area as lv_keyboard, 106x30 px keys
+  lv_obj_align(keypad, LV_ALIGN_BOTTOM_MID, 0, 0);
+  lv_obj_add_event_cb(keypad, keypad_event_handler, LV_EVENT_VALUE_CHANGED, NULL);
+  value = 0;
+  show_value();
+  return keypad;
+}
+
+void id_keypad_set_range(uint16_t min, uint16_t max) {
+  minId = min;
+  maxId = max;
+}
+
+void id_keypad_set_value(uint16_t newValue) {
+  value = newValue <= maxId ? newValue : 0;
+  show_value();
+}
+
+uint16_t id_keypad_get_value() { return value; }
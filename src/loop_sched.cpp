@@ -0,0 +1,81 @@
+/*
+Description: Main loop scheduler. loop_sched_plan() is plain logic shared with the native build; the waiting is a
+task notification on the loop task, given by the fingerprint service when it posts a result and by the PENIRQ
+interrupt (touch_irq.cpp), or a timer/GPIO-woken light sleep. The native build keeps its fixed virtual tick and only uses the plan.
+*/
+
+#include <Arduino.h>
+#include "loop_sched.h"
+#ifdef ARDUINO
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#endif
+
+static int8_t touchIrqPin = -1;  // PENIRQ GPIO, -1 if not wired
+
+uint32_t loop_sched_plan(uint32_t lvglWaitMs, bool menuIdle, uint32_t inactiveMs, bool *lightSleep) {
+  bool sleep = touchIrqPin >= 0 && menuIdle && inactiveMs >= LOOP_IDLE_SLEEP_MS;  // Nothing but a touch can happen
+  if (lightSleep) *lightSleep = sleep;
+  if (sleep) return LOOP_LIGHT_SLEEP_MS;  // The menu is static, LVGL timers can wait for the touch
+  if (lvglWaitMs < LOOP_MIN_WAIT_MS) return LOOP_MIN_WAIT_MS;
+  if (lvglWaitMs > LOOP_MAX_WAIT_MS) return LOOP_MAX_WAIT_MS;  // Also LV_NO_TIMER_READY
+  return lvglWaitMs;
+}
+
+#ifdef ARDUINO
+static TaskHandle_t loopTask = NULL;   // Task running loop()
+static volatile bool touched = false;  // PENIRQ fired since the last sleep
+
+void IRAM_ATTR loop_sched_touch_from_isr() {
+  if (!loopTask) return;
+  BaseType_t woken = pdFALSE;
+  touched = true;
+  vTaskNotifyGiveFromISR(loopTask, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+bool loop_sched_begin(int8_t pin) {
+  loopTask = xTaskGetCurrentTaskHandle();
+  if (pin < 0) return false;  // LVGL polls the touch every LOOP_MAX_WAIT_MS
+  touchIrqPin = pin;  // The interrupt itself belongs to touch_irq.cpp
+  return true;
+}
+
+bool loop_sched_sleep(uint32_t ms, bool lightSleep) {
+  if (!lightSleep) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));  // Timer deadline, result or touch, whichever comes first
+  } else {
+    Serial.flush();  // The UART stops during light sleep
+    esp_sleep_enable_timer_wakeup((uint64_t)ms * 1000);
+    gpio_wakeup_enable((gpio_num_t)touchIrqPin, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_light_sleep_start();
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) touched = true;
+    gpio_wakeup_disable((gpio_num_t)touchIrqPin);
+    gpio_set_intr_type((gpio_num_t)touchIrqPin, GPIO_INTR_NEGEDGE);  // Wake-up config replaced the edge interrupt
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  }
+  bool wasTouched = touched;
+  touched = false;
+  return wasTouched;
+}
+
+void loop_sched_wake() {
+  if (loopTask) xTaskNotifyGive(loopTask);
+}
+#else
+bool loop_sched_begin(int8_t pin) {
+  touchIrqPin = pin;  // Only affects the plan on the host
+  return pin >= 0;
+}
+
+bool loop_sched_sleep(uint32_t ms, bool lightSleep) {
+  (void)lightSleep;
+  delay(ms);
+  return false;
+}
+
+void loop_sched_wake() {}
+
+void loop_sched_touch_from_isr() {}
+#endif
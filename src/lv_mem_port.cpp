@@ -0,0 +1,74 @@
+/*
+Description: Backends of LVGL's heap (see lv_mem_port.h). The heap backend prefixes every block with its size, so
+frees and reallocs can be counted without asking the allocator; LVGL only calls these from the LVGL thread.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "lv_mem_port.h"
+#include "serial_log.h"
+#ifdef ARDUINO
+#include <esp_heap_caps.h>  // PSRAM and internal RAM allocation
+#endif
+
+#define BLOCK_HEADER 8  // Size prefix, keeps the 8-byte alignment malloc() returns
+
+static uint32_t heapUsed = 0;     // Bytes LVGL holds, headers excluded
+static uint32_t heapMaxUsed = 0;  // Peak of heapUsed
+static bool poolInPsram = false;  // Where lv_mem_port_pool_alloc() put the pool
+
+/* Count a block handed to LVGL (add) and one given back (sub) */
+static void heap_account(uint32_t add, uint32_t sub) {
+  heapUsed = heapUsed - sub + add;
+  if (heapUsed > heapMaxUsed) heapMaxUsed = heapUsed;
+}
+
+void *lv_mem_port_malloc(size_t size) {
+  uint8_t *block = (uint8_t *)malloc(size + BLOCK_HEADER);
+  if (!block) return NULL;
+  memcpy(block, &size, sizeof(size));
+  heap_account(size, 0);
+  return block + BLOCK_HEADER;
+}
+
+void lv_mem_port_free(void *p) {
+  if (!p) return;
+  uint8_t *block = (uint8_t *)p - BLOCK_HEADER;
+  size_t size;
+  memcpy(&size, block, sizeof(size));
+  heap_account(0, size);
+  free(block);
+}
+
+void *lv_mem_port_realloc(void *p, size_t size) {
+  if (!p) return lv_mem_port_malloc(size);
+  uint8_t *block = (uint8_t *)p - BLOCK_HEADER;
+  size_t oldSize;
+  memcpy(&oldSize, block, sizeof(oldSize));
+  block = (uint8_t *)realloc(block, size + BLOCK_HEADER);
+  if (!block) return NULL;  // The old block is still valid and counted
+  memcpy(block, &size, sizeof(size));
+  heap_account(size, oldSize);
+  return block + BLOCK_HEADER;
+}
+
+uint32_t lv_mem_port_used() { return heapUsed; }
+
+uint32_t lv_mem_port_max_used() { return heapMaxUsed; }
+
+void *lv_mem_port_pool_alloc(size_t size) {
+#ifdef ARDUINO
+  void *pool = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  poolInPsram = pool != NULL;
+  if (!pool) {
+    LOG_W("No PSRAM, LVGL pool of %u bytes in internal RAM.", (unsigned)size);
+    pool = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  }
+#else
+  void *pool = malloc(size);  // The host has no PSRAM
+#endif
+  if (!pool) LOG_E("LVGL pool of %u bytes could not be allocated.", (unsigned)size);
+  return pool;
+}
+
+bool lv_mem_port_pool_in_psram() { return poolInPsram; }
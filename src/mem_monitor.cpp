@@ -0,0 +1,99 @@
+/*
+Description: LVGL heap monitor (see mem_monitor.h). Runs from an LVGL timer, so it reads the heap on the LVGL thread
+like every allocation does. The overlay label is created once and only relabeled when its text changes.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <lvgl.h>
+#include "mem_monitor.h"
+#include "lv_mem_port.h"
+#include "serial_log.h"
+#ifdef ARDUINO
+#include <esp_heap_caps.h>  // Heap figures for the heap backend
+#endif
+
+static lv_obj_t *overlay = NULL;  // Figures on the system layer, NULL without overlay
+
+uint8_t mem_frag_pct(uint32_t freeBytes, uint32_t largestFree) {
+  if (freeBytes == 0 || largestFree >= freeBytes) return 0;
+  return 100 - (uint8_t)((uint64_t)largestFree * 100 / freeBytes);
+}
+
+void mem_stats_read(mem_stats_t *stats) {
+#if LV_MEM_CUSTOM == 0
+  lv_mem_monitor_t mon;  // LVGL's TLSF pool, internal RAM or PSRAM
+  lv_mem_monitor(&mon);
+  stats->total = mon.total_size;
+  stats->used = mon.total_size - mon.free_size;
+  stats->maxUsed = mon.max_used;
+  stats->freeBytes = mon.free_size;
+  stats->largestFree = mon.free_biggest_size;
+#else
+  stats->used = lv_mem_port_used();  // LVGL shares the heap: only its own blocks are counted as used
+  stats->maxUsed = lv_mem_port_max_used();
+#ifdef ARDUINO
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+  stats->total = info.total_free_bytes + info.total_allocated_bytes;
+  stats->freeBytes = info.total_free_bytes;
+  stats->largestFree = info.largest_free_block;
+#else
+  stats->total = stats->freeBytes = stats->largestFree = 0;  // Host malloc() has no figures
+#endif
+#endif
+  stats->fragPct = mem_frag_pct(stats->freeBytes, stats->largestFree);
+}
+
+const char *mem_backend_name() {
+#if LV_MEM_BACKEND == LV_MEM_BACKEND_HEAP
+  return "heap";
+#elif LV_MEM_BACKEND == LV_MEM_BACKEND_PSRAM
+  return lv_mem_port_pool_in_psram() ? "psram" : "psram (internal)";
+#else
+  return "pool";
+#endif
+}
+
+/* Bytes as kB with one decimal: "12.3" */
+static void format_kb(char *buf, size_t len, uint32_t bytes) {
+  snprintf(buf, len, "%lu.%lu", (unsigned long)(bytes / 1024), (unsigned long)(bytes % 1024 * 10 / 1024));
+}
+
+size_t mem_stats_format(const mem_stats_t *stats, char *buf, size_t len) {
+  char used[12], total[12], maxUsed[12], largest[12];
+  format_kb(used, sizeof(used), stats->used);
+  format_kb(total, sizeof(total), stats->total);
+  format_kb(maxUsed, sizeof(maxUsed), stats->maxUsed);
+  format_kb(largest, sizeof(largest), stats->largestFree);
+  return snprintf(buf, len, "%s/%s kB, max %s kB, frag %u%%, largest %s kB", used, total, maxUsed,
+                  stats->fragPct, largest);
+}
+
+void mem_monitor_report() {
+  mem_stats_t stats;
+  char line[80];
+  mem_stats_read(&stats);
+  mem_stats_format(&stats, line, sizeof(line));
+  LOG_I("LVGL mem (%s): %s", mem_backend_name(), line);
+  if (overlay && strcmp(lv_label_get_text(overlay), line) != 0) {
+    lv_label_set_text(overlay, line);  // Redrawn only when a figure changed
+  }
+}
+
+/* LVGL timer: one report per period */
+static void mem_monitor_tick(lv_timer_t *) {
+  mem_monitor_report();
+}
+
+void mem_monitor_begin(bool overlayOn) {
+  if (overlayOn) {
+    overlay = lv_label_create(lv_layer_sys());  // Above every screen, survives screen loads
+    lv_obj_set_style_bg_color(overlay, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(overlay, LV_OPA_60, 0);
+    lv_obj_set_style_text_color(overlay, lv_color_white(), 0);
+    lv_obj_align(overlay, LV_ALIGN_TOP_LEFT, 0, 0);
+  }
+  lv_timer_t *timer = lv_timer_create(mem_monitor_tick, MEM_MONITOR_PERIOD_MS, NULL);
+  lv_timer_ready(timer);  // First report on the next lv_timer_handler()
+}
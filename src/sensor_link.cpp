@@ -0,0 +1,98 @@
+/*
+Description: Baud-rate negotiation with the fingerprint sensor. The module keeps its baud rate in flash, so after
+a previous negotiation it no longer answers at the factory 57600; the link is therefore found by probing the
+likely rates first, then raised with setBaudRate() (system-parameter write). The sensor acknowledges at the old
+rate and switches afterwards, so mySerial follows and the handshake is repeated at the new rate. If that fails the
+old rate is restored on both ends. The system parameters (capacity above all) are read once the final rate is in
+use; a sensor that answers but does not report them fails the handshake, since nothing could be enrolled or found.
+*/
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+#include "sensor_link.h"
+#include "serial_log.h"
+
+extern HardwareSerial mySerial;      // Serial port of the fingerprint sensor (defined in main.cpp)
+extern Adafruit_Fingerprint finger;  // Fingerprint sensor (defined in main.cpp)
+
+#define SENSOR_SWITCH_DELAY_MS 50    // Time the sensor needs to reconfigure its UART after setBaudRate()
+#define SENSOR_PARAM_TRIES 3         // getParameters() attempts at the final rate
+
+// Rates tried when looking for the sensor, most likely first
+static const uint32_t probeRates[] = {SENSOR_TARGET_BAUD, SENSOR_DEFAULT_BAUD, 9600, 19200, 38400};
+
+/* Reopen mySerial at a new rate and check that the sensor answers */
+static bool sensor_link_try(uint32_t baud) {
+  mySerial.updateBaudRate(baud);
+  while (mySerial.available()) mySerial.read();  // Drop bytes received at the old rate
+  return finger.verifyPassword();
+}
+
+/* Read the system parameters at the rate in use; returns baud, or 0 if the sensor does not report them */
+static uint32_t sensor_link_ready(uint32_t baud) {
+  for (uint8_t i = 0; i < SENSOR_PARAM_TRIES; i++) {
+    if (finger.getParameters() == FINGERPRINT_OK && finger.capacity > 0) {
+      LOG_I("Sensor link at %lu baud (configured %lu), capacity %d",
+            (unsigned long)baud, (unsigned long)finger.baud_rate, finger.capacity);
+      return baud;
+    }
+  }
+  LOG_E("Sensor answers at %lu baud but reports no parameters.", (unsigned long)baud);
+  return 0;
+}
+
+uint32_t sensor_link_open(int8_t rxPin, int8_t txPin) {
+  uint32_t baud = 0;  // Rate the sensor answers at
+
+  mySerial.begin(SENSOR_DEFAULT_BAUD, SERIAL_8N1, rxPin, txPin);
+  for (uint32_t rate : probeRates) {
+    if (sensor_link_try(rate)) {
+      baud = rate;
+      break;
+    }
+  }
+  if (baud == 0) return 0;  // No sensor at any rate
+
+#ifdef SENSOR_BAUD_PROFILE
+  finger.getParameters();   // Capacity for fingerSearch()
+  sensor_link_profile(20);  // Cycle time before raising the rate
+#endif
+
+  if (baud >= SENSOR_TARGET_BAUD) return sensor_link_ready(baud);  // Already as fast as it gets
+
+  if (finger.setBaudRate(SENSOR_TARGET_BAUD / 9600) != FINGERPRINT_OK) {
+    LOG_W("Sensor refused the new baud rate, keeping the old one.");
+    return sensor_link_ready(baud);
+  }
+  delay(SENSOR_SWITCH_DELAY_MS);
+
+  if (sensor_link_try(SENSOR_TARGET_BAUD)) {
+    LOG_I("Sensor link raised to %lu baud", (unsigned long)SENSOR_TARGET_BAUD);
+    baud = sensor_link_ready(SENSOR_TARGET_BAUD);  // Parameters as the sensor reports them at the new rate
+#ifdef SENSOR_BAUD_PROFILE
+    if (baud) sensor_link_profile(20);  // Cycle time after raising the rate
+#endif
+    return baud;
+  }
+
+  // Handshake failed at the new rate: go back to the old one on both ends
+  LOG_W("No answer at the new baud rate, falling back.");
+  if (sensor_link_try(baud)) return sensor_link_ready(baud);
+  for (uint32_t rate : probeRates) {  // The sensor may have switched after all
+    if (sensor_link_try(rate)) return sensor_link_ready(rate);
+  }
+  return 0;
+}
+
+void sensor_link_profile(uint16_t cycles) {
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < cycles; i++) {
+    // Same commands as a scan; without a finger image2Tz and fingerSearch fail fast, which still
+    // exercises the full command/response exchange of each packet
+    finger.getImage();
+    finger.image2Tz();
+    finger.fingerSearch();
+  }
+  uint32_t elapsed = micros() - start;
+  Serial.printf("getImage+image2Tz+fingerSearch: %lu us per cycle\n", (unsigned long)(elapsed / cycles));
+}
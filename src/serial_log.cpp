@@ -0,0 +1,154 @@
+/*
+Description: Serial log ring and writer. The ring is a bounded multi-producer queue of fixed-size line slots (the
+fingerprint task and the LVGL thread both log): a producer claims a position with a compare-and-swap on head, fills
+the slot and publishes it through the slot's tag; the single writer consumes in order and hands the slot back to the
+next lap. Nobody waits: a producer that finds the ring full drops its line and counts it.
+Tags: a slot free for position p holds p rounded down to a multiple of SERIAL_LOG_SLOTS, a filled one that plus 1,
+so the all-zero start state is valid without an init call and the arithmetic survives the 32-bit wrap.
+*/
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <atomic>
+#include "serial_log.h"
+
+static_assert((SERIAL_LOG_SLOTS & (SERIAL_LOG_SLOTS - 1)) == 0, "SERIAL_LOG_SLOTS must be a power of two");
+
+#define SERIAL_LOG_LAP (~(uint32_t)(SERIAL_LOG_SLOTS - 1))  // Mask giving the first position of a lap
+
+struct serial_log_slot_t {
+  std::atomic<uint32_t> tag;        // Free/filled marker, see above
+  uint8_t level;                    // SERIAL_LOG_ERROR..SERIAL_LOG_DEBUG
+  char text[SERIAL_LOG_LINE_MAX];   // NUL-terminated line without newline
+};
+
+static serial_log_slot_t slots[SERIAL_LOG_SLOTS];
+static std::atomic<uint32_t> head(0);     // Next position to claim (producers)
+static uint32_t tail = 0;                 // Next position to write (writer only)
+static std::atomic<uint32_t> dropped(0);  // Lines lost, ring full or rate limited
+static volatile uint8_t level = SERIAL_LOG_LEVEL;  // Runtime level
+static serial_log_sink_t sink = NULL;     // NULL: Serial
+
+// Writer state
+static char lastLine[SERIAL_LOG_LINE_MAX];  // Last line written, to spot repeats
+static uint8_t lastLevel = SERIAL_LOG_INFO;
+static uint32_t repeats = 0;                // Copies of lastLine not written yet
+static uint32_t repeatSince = 0;            // millis() of the first of them
+static uint32_t credit = SERIAL_LOG_RATE * 1000UL;  // Rate limit bucket, 1000 per line
+static uint32_t creditTime = 0;             // millis() of the last refill
+static uint32_t rateSkipped = 0;            // Lines over the rate limit not reported yet
+
+void serial_log_write(uint8_t lineLevel, const char *fmt, ...) {
+  if (lineLevel > level) return;
+  uint32_t pos = head.load(std::memory_order_relaxed);
+  serial_log_slot_t *slot;
+  for (;;) {
+    slot = &slots[pos % SERIAL_LOG_SLOTS];
+    uint32_t tag = slot->tag.load(std::memory_order_acquire);
+    int32_t diff = (int32_t)(tag - (pos & SERIAL_LOG_LAP));
+    if (diff == 0) {
+      if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;  // Claimed
+    } else if (diff < 0) {
+      dropped.fetch_add(1, std::memory_order_relaxed);  // Writer is a whole ring behind
+      return;
+    } else {
+      pos = head.load(std::memory_order_relaxed);  // Another producer got there first
+    }
+  }
+
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(slot->text, sizeof(slot->text), fmt, args);
+  va_end(args);
+  slot->level = lineLevel;
+  slot->tag.store((pos & SERIAL_LOG_LAP) + 1, std::memory_order_release);  // Publish
+}
+
+/* Default sink */
+static void serial_log_print(uint8_t lineLevel, const char *line) {
+  if (lineLevel == SERIAL_LOG_ERROR) Serial.print("E: ");
+  else if (lineLevel == SERIAL_LOG_WARN) Serial.print("W: ");
+  Serial.println(line);
+}
+
+/* Write one line if the rate limit allows it */
+static bool serial_log_emit(uint8_t lineLevel, const char *line) {
+  if (credit < 1000) {
+    rateSkipped++;
+    dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  credit -= 1000;
+  (sink ? sink : serial_log_print)(lineLevel, line);
+  return true;
+}
+
+/* Report a run of repeated lines */
+static void serial_log_flush_repeats() {
+  if (repeats == 0) return;
+  char line[48];
+  snprintf(line, sizeof(line), "(last line repeated %lu times)", (unsigned long)repeats);
+  serial_log_emit(lastLevel, line);
+  repeats = 0;
+}
+
+void serial_log_drain() {
+  uint32_t now = millis();
+  credit += (now - creditTime) * SERIAL_LOG_RATE;
+  if (credit > SERIAL_LOG_RATE * 1000UL) credit = SERIAL_LOG_RATE * 1000UL;
+  creditTime = now;
+
+  if (rateSkipped && credit >= 2000) {  // Room for the report and one more line
+    char line[48];
+    snprintf(line, sizeof(line), "(%lu lines over the rate limit dropped)", (unsigned long)rateSkipped);
+    rateSkipped = 0;
+    serial_log_emit(SERIAL_LOG_WARN, line);
+  }
+
+  for (;;) {
+    serial_log_slot_t *slot = &slots[tail % SERIAL_LOG_SLOTS];
+    if (slot->tag.load(std::memory_order_acquire) != (tail & SERIAL_LOG_LAP) + 1) break;  // Nothing published
+
+    if (strcmp(slot->text, lastLine) == 0 && slot->level == lastLevel) {
+      if (repeats++ == 0) repeatSince = now;
+    } else {
+      serial_log_flush_repeats();
+      if (serial_log_emit(slot->level, slot->text)) {
+        memcpy(lastLine, slot->text, sizeof(lastLine));
+        lastLevel = slot->level;
+      }
+    }
+    slot->tag.store((tail & SERIAL_LOG_LAP) + SERIAL_LOG_SLOTS, std::memory_order_release);  // Free for the next lap
+    tail++;
+  }
+  if (repeats && now - repeatSince >= SERIAL_LOG_REPEAT_MS) serial_log_flush_repeats();
+}
+
+void serial_log_set_level(uint8_t newLevel) { level = newLevel; }
+
+uint8_t serial_log_level() { return level; }
+
+void serial_log_set_sink(serial_log_sink_t newSink) { sink = newSink; }
+
+uint32_t serial_log_dropped() { return dropped.load(std::memory_order_relaxed); }
+
+#ifdef ARDUINO
+/* Writer task: the only place that blocks on the UART */
+static void serial_log_task(void *arg) {
+  for (;;) {
+    serial_log_drain();
+    vTaskDelay(pdMS_TO_TICKS(SERIAL_LOG_DRAIN_MS));
+  }
+}
+
+bool serial_log_begin() {
+  creditTime = millis();
+  return xTaskCreatePinnedToCore(serial_log_task, "log", SERIAL_LOG_STACK, NULL,
+                                 SERIAL_LOG_PRIORITY, NULL, SERIAL_LOG_CORE) == pdPASS;
+}
+#else
+bool serial_log_begin() {
+  creditTime = millis();
+  return true;  // No task on the host: the main loop calls serial_log_drain()
+}
+#endif
@@ -0,0 +1,83 @@
+/*
+Description: Change-only status label updates. lv_label_set_text() always invalidates the label, even when the
+text is identical, which in scan mode meant redrawing "No Finger Detected" about every 5 ms. Here the new message
+is compared against the current one (by id for fixed messages, by string for free text) and the label is only
+touched when it differs. Skipped updates are counted so an idle reader can be confirmed to leave the SPI bus idle.
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "status_label.h"
+#include "trace.h"
+
+#define STATUS_FMT_MAX 64  // Longest formatted status message
+
+static const char *const statusMessages[STATUS_MSG_COUNT] = {
+  "",                                   // STATUS_TEXT (not used)
+  "Select Enroll or Scan.",             // STATUS_SELECT
+  "Scanning...",                        // STATUS_SCANNING
+  "Returning to main menu...",          // STATUS_RETURNING
+  "Enrolling, please enter the ID:",    // STATUS_ENTER_ID
+  "No Finger Detected",                 // STATUS_NO_FINGER
+  "No Match Found",                     // STATUS_NO_MATCH
+  "Fingerprint library is full.",       // STATUS_LIBRARY_FULL
+  "Finger not read, please try again.", // STATUS_READ_ERROR
+  "Connecting to the sensor...",        // STATUS_CONNECTING
+  "Fingerprint sensor not found.",      // STATUS_NO_SENSOR
+};
+
+static lv_obj_t *statusLabel = NULL;           // Wrapped label (fingerLabel)
+static status_msg_t currentMsg = STATUS_TEXT;  // Message currently shown
+static uint32_t updateCount = 0;               // Updates that changed the label
+static uint32_t skipCount = 0;                 // Updates skipped because nothing changed
+
+void status_init(lv_obj_t *label) {
+  statusLabel = label;
+  currentMsg = STATUS_TEXT;
+  lv_label_set_text(statusLabel, "");  // Known starting point for string comparisons
+}
+
+bool status_show(status_msg_t msg) {
+  if (msg == currentMsg) {  // Same fixed message, nothing to redraw
+    skipCount++;
+    return false;
+  }
+  TRACE_INSTANT(TRACE_LABEL, msg);
+  lv_label_set_text_static(statusLabel, statusMessages[msg]);  // Table strings outlive the label, no copy needed
+  currentMsg = msg;
+  updateCount++;
+  return true;
+}
+
+bool status_set(const char *text) {
+  if (strcmp(lv_label_get_text(statusLabel), text) == 0) {  // Label already shows this text
+    skipCount++;
+    return false;
+  }
+  TRACE_INSTANT(TRACE_LABEL, STATUS_TEXT);
+  lv_label_set_text(statusLabel, text);  // Copies the text and invalidates the label
+  currentMsg = STATUS_TEXT;
+  updateCount++;
+  return true;
+}
+
+bool status_set_fmt(const char *fmt, ...) {
+  char text[STATUS_FMT_MAX];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(text, sizeof(text), fmt, args);  // Format first so the result can be compared
+  va_end(args);
+  return status_set(text);
+}
+
+const char *status_text(status_msg_t msg) { return statusMessages[msg]; }
+
+uint32_t status_update_count() { return updateCount; }
+
+uint32_t status_skip_count() { return skipCount; }
+
+void status_reset_counters() {
+  updateCount = 0;
+  skipCount = 0;
+}
@@ -0,0 +1,79 @@
+/*
+Description: Touch calibration record in NVS (see touch_cal.h). The native build keeps the record in RAM in place
+of NVS so the encoding and the load/save logic can be unit tested.
+*/
+
+#include <Arduino.h>
+#include "touch_cal.h"
+#include "crc16.h"
+#include "serial_log.h"
+#ifdef ARDUINO
+#include <Preferences.h>
+#endif
+
+size_t touch_cal_encode(const uint16_t cal[TOUCH_CAL_VALUES], uint8_t rotation, uint8_t *record) {
+  record[0] = 'T';
+  record[1] = 'C';
+  record[2] = TOUCH_CAL_VERSION;
+  record[3] = rotation;
+  for (uint8_t i = 0; i < TOUCH_CAL_VALUES; i++) {
+    record[4 + 2 * i] = cal[i] & 0xFF;
+    record[5 + 2 * i] = cal[i] >> 8;
+  }
+  uint16_t crc = crc16_ccitt(record, TOUCH_CAL_RECORD_SIZE - 2);
+  record[TOUCH_CAL_RECORD_SIZE - 2] = crc & 0xFF;
+  record[TOUCH_CAL_RECORD_SIZE - 1] = crc >> 8;
+  return TOUCH_CAL_RECORD_SIZE;
+}
+
+bool touch_cal_decode(const uint8_t *record, size_t len, uint8_t rotation, uint16_t cal[TOUCH_CAL_VALUES]) {
+  if (len != TOUCH_CAL_RECORD_SIZE || record[0] != 'T' || record[1] != 'C') return false;
+  uint16_t crc = record[TOUCH_CAL_RECORD_SIZE - 2] | (record[TOUCH_CAL_RECORD_SIZE - 1] << 8);
+  if (crc != crc16_ccitt(record, TOUCH_CAL_RECORD_SIZE - 2)) {
+    LOG_W("Touch calibration record corrupted.");
+    return false;
+  }
+  if (record[2] != TOUCH_CAL_VERSION) {
+    LOG_W("Touch calibration record version %u, expected %u.", record[2], TOUCH_CAL_VERSION);
+    return false;
+  }
+  if (record[3] != rotation) {
+    LOG_W("Touch calibrated at rotation %u, display uses %u.", record[3], rotation);
+    return false;
+  }
+  for (uint8_t i = 0; i < TOUCH_CAL_VALUES; i++) cal[i] = record[4 + 2 * i] | (record[5 + 2 * i] << 8);
+  return true;
+}
+
+#ifdef ARDUINO
+bool touch_cal_load(uint8_t rotation, uint16_t cal[TOUCH_CAL_VALUES]) {
+  Preferences prefs;
+  if (!prefs.begin(TOUCH_CAL_NAMESPACE, true)) return false;  // Never calibrated: no namespace yet
+  uint8_t record[TOUCH_CAL_RECORD_SIZE];
+  size_t len = prefs.getBytesLength(TOUCH_CAL_KEY) == sizeof(record) ? prefs.getBytes(TOUCH_CAL_KEY, record, sizeof(record)) : 0;
+  prefs.end();
+  return touch_cal_decode(record, len, rotation, cal);
+}
+
+bool touch_cal_save(const uint16_t cal[TOUCH_CAL_VALUES], uint8_t rotation) {
+  uint8_t record[TOUCH_CAL_RECORD_SIZE];
+  touch_cal_encode(cal, rotation, record);
+  Preferences prefs;
+  if (!prefs.begin(TOUCH_CAL_NAMESPACE, false)) return false;
+  bool ok = prefs.putBytes(TOUCH_CAL_KEY, record, sizeof(record)) == sizeof(record);
+  prefs.end();
+  return ok;
+}
+#else
+static uint8_t nvsRecord[TOUCH_CAL_RECORD_SIZE];  // Stands in for the NVS entry
+static size_t nvsLength = 0;
+
+bool touch_cal_load(uint8_t rotation, uint16_t cal[TOUCH_CAL_VALUES]) {
+  return touch_cal_decode(nvsRecord, nvsLength, rotation, cal);
+}
+
+bool touch_cal_save(const uint16_t cal[TOUCH_CAL_VALUES], uint8_t rotation) {
+  nvsLength = touch_cal_encode(cal, rotation, nvsRecord);
+  return true;
+}
+#endif
@@ -0,0 +1,67 @@
+/*
+Description: Touch sample pipeline (see touch_filter.h). A poll counts as pressed when most of its readings pass the
+pressure threshold of the current state; only those readings give the position. The first position of a press
+is taken as is, later ones move the filtered position part of the way, so a new press never slides in from where
+the last one ended.
+*/
+
+#include "touch_filter.h"
+
+/* Median of a short array, sorted in place (insertion sort, count <= TOUCH_OVERSAMPLE_MAX) */
+static int16_t touch_filter_median(int16_t *v, uint8_t count) {
+  for (uint8_t i = 1; i < count; i++) {
+    int16_t key = v[i];
+    int8_t j = i - 1;
+    while (j >= 0 && v[j] > key) {
+      v[j + 1] = v[j];
+      j--;
+    }
+    v[j + 1] = key;
+  }
+  return v[(count - 1) / 2];
+}
+
+void touch_filter_init(touch_filter_t *f) {
+  f->pressed = false;
+  f->pending = 0;
+  f->x = 0;
+  f->y = 0;
+}
+
+bool touch_filter_update(touch_filter_t *f, const touch_sample_t *samples, uint8_t count, int16_t *x, int16_t *y) {
+  if (count > TOUCH_OVERSAMPLE_MAX) count = TOUCH_OVERSAMPLE_MAX;
+  uint16_t threshold = f->pressed ? TOUCH_Z_RELEASE : TOUCH_Z_PRESS;  // Hysteresis
+  int16_t xs[TOUCH_OVERSAMPLE_MAX], ys[TOUCH_OVERSAMPLE_MAX];
+  uint8_t valid = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (samples[i].z < threshold) continue;
+    xs[valid] = samples[i].x;
+    ys[valid] = samples[i].y;
+    valid++;
+  }
+  bool down = valid * 2 > count;  // Majority of the readings
+
+  bool seed = false;  // Press starts with this poll
+  if (down == f->pressed) {
+    f->pending = 0;
+  } else if (++f->pending >= (down ? TOUCH_PRESS_POLLS : TOUCH_RELEASE_POLLS)) {
+    f->pressed = down;
+    f->pending = 0;
+    seed = down;
+  }
+
+  if (f->pressed && down) {  // A pressed poll inside a press moves the position
+    int32_t mx = (int32_t)touch_filter_median(xs, valid) << TOUCH_FILTER_FRAC;
+    int32_t my = (int32_t)touch_filter_median(ys, valid) << TOUCH_FILTER_FRAC;
+    if (seed) {
+      f->x = mx;
+      f->y = my;
+    } else {
+      f->x += (mx - f->x) / (1 << TOUCH_IIR_SHIFT);
+      f->y += (my - f->y) / (1 << TOUCH_IIR_SHIFT);
+    }
+  }
+  *x = (f->x + (1 << (TOUCH_FILTER_FRAC - 1))) >> TOUCH_FILTER_FRAC;  // Rounded
+  *y = (f->y + (1 << (TOUCH_FILTER_FRAC - 1))) >> TOUCH_FILTER_FRAC;
+  return f->pressed;
+}
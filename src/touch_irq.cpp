@@ -0,0 +1,39 @@
+/*
+Description: PENIRQ line of the touch controller. A falling edge latches a pending touch and wakes the main loop;
+the level is checked as well, so a press that started before the last clear is never missed.
+*/
+
+#include <Arduino.h>
+#include "touch_irq.h"
+#include "loop_sched.h"
+#include "serial_log.h"
+
+static int8_t irqPin = -1;             // PENIRQ GPIO, -1 if not wired
+static volatile bool latched = false;  // Falling edge since the last clear
+static uint32_t skipCount = 0;         // Polls answered without SPI
+
+/* PENIRQ falling edge: the panel was pressed */
+static void IRAM_ATTR touch_irq_isr() {
+  latched = true;
+  loop_sched_touch_from_isr();
+}
+
+bool touch_irq_begin(int8_t pin) {
+  if (pin < 0) return false;  // Not wired, the read callback polls the controller
+  irqPin = pin;
+  pinMode(irqPin, INPUT_PULLUP);  // Open drain output, low while pressed
+  attachInterrupt(digitalPinToInterrupt(irqPin), touch_irq_isr, FALLING);
+  LOG_I("Touch PENIRQ on GPIO %d", irqPin);
+  return true;
+}
+
+bool touch_irq_pending() {
+  if (irqPin < 0) return true;
+  if (latched || digitalRead(irqPin) == LOW) return true;
+  skipCount++;
+  return false;
+}
+
+void touch_irq_clear() { latched = false; }
+
+uint32_t touch_irq_skip_count() { return skipCount; }
@@ -0,0 +1,75 @@
+/*
+Description: Trace ring. A trace point claims the next position with one atomic increment and fills the slot, so it
+never blocks and works from both cores; when the ring is full the oldest records are overwritten. Reading is meant
+for a quiet moment (the dump command): recording is paused while the ring is copied out.
+Dump format, one record per line between the markers:
+  # trace begin <records>
+  # event <id> <name>
+  <us> <event id> <phase> <core> <arg>
+  # trace end
+*/
+
+#include <Arduino.h>
+#include <atomic>
+#include "trace.h"
+#ifdef ARDUINO
+#include <esp_timer.h>
+#endif
+
+static_assert((TRACE_RING & (TRACE_RING - 1)) == 0, "TRACE_RING must be a power of two");
+
+static const char *const eventNames[TRACE_EVENT_COUNT] = {
+  "scan", "getImage", "image2Tz", "search", "enroll step", "lvgl", "label", "flush", "result",
+};
+
+static trace_record_t ring[TRACE_RING];
+static std::atomic<uint32_t> written(0);  // Records ever recorded; the next one goes to written % TRACE_RING
+static volatile bool paused = false;      // Set while the ring is read
+
+void trace_point(uint8_t event, char phase, uint8_t arg) {
+  if (paused) return;
+  // Time first, then the slot: ring order then follows time except for points racing on the other core
+#ifdef ARDUINO
+  uint32_t us = (uint32_t)esp_timer_get_time();
+#else
+  uint32_t us = micros();
+#endif
+  trace_record_t *r = &ring[written.fetch_add(1, std::memory_order_relaxed) % TRACE_RING];
+  r->us = us;
+#ifdef ARDUINO
+  r->core = xPortGetCoreID();
+#else
+  r->core = 0;
+#endif
+  r->event = event;
+  r->phase = phase;
+  r->arg = arg;
+}
+
+uint16_t trace_read(trace_record_t *out, uint16_t max) {
+  paused = true;
+  uint32_t end = written.load(std::memory_order_acquire);
+  uint32_t count = end < TRACE_RING ? end : TRACE_RING;
+  if (count > max) count = max;
+  for (uint32_t i = 0; i < count; i++) out[i] = ring[(end - count + i) % TRACE_RING];
+  paused = false;
+  return count;
+}
+
+const char *trace_event_name(uint8_t event) {
+  return event < TRACE_EVENT_COUNT ? eventNames[event] : "?";
+}
+
+void trace_dump() {
+  static trace_record_t copy[TRACE_RING];  // Not on the loop task's stack
+  uint16_t count = trace_read(copy, TRACE_RING);
+  Serial.printf("# trace begin %u\n", count);
+  for (uint8_t e = 0; e < TRACE_EVENT_COUNT; e++) Serial.printf("# event %u %s\n", e, eventNames[e]);
+  for (uint16_t i = 0; i < count; i++) {
+    const trace_record_t *r = &copy[i];
+    Serial.printf("%lu %u %c %u %u\n", (unsigned long)r->us, r->event, r->phase, r->core, r->arg);
+  }
+  Serial.println("# trace end");
+}
+
+void trace_clear() { written.store(0, std::memory_order_release); }
@@ -0,0 +1,232 @@
+/*
+Description: LVGL user interface of the fingerprint terminal. Builds one screen per mode (main menu, scanning,
+ID keypad, name entry, enrolling, enrollment result) for the navigator in ui_nav.cpp and handles their events; a
+screen is only built the first time it is shown, so the keyboard is not created until someone enters a name.
+Hardware independent so it also builds for the native host target.
+*/
+
+#include <Arduino.h>  // Serial logging (host builds use the shim in src/host)
+#include <lvgl.h>     // LittlevGL graphics library for the display
+#include "ui.h"
+#include "ui_nav.h"
+#include "id_keypad.h"
+#include "status_label.h"
+#include "fp_service.h"
+#include "fp_slots.h"
+#include "user_dir.h"
+#include "serial_log.h"
+
+// Global objects for UI elements
+lv_obj_t *fingerLabel;     // Label to display fingerprint status messages
+lv_obj_t *scanButton;      // Button to initiate fingerprint scanning
+lv_obj_t *enrollButton;    // Button to start fingerprint enrollment
+lv_obj_t *inputTextArea = NULL; // Text area for entering fingerprint ID during enrollment (created on demand)
+lv_obj_t *keyboard = NULL;      // Virtual keyboard for the user name (created on demand)
+lv_obj_t *idKeypad = NULL;      // Numeric keypad for the ID (created on demand)
+lv_obj_t *idLabel;         // Label to display entered ID
+lv_obj_t *returnButton = NULL; // Button to cancel the enrollment (enrolling screen)
+
+uint16_t id = 0;  // Fingerprint ID to be enrolled
+char enrollName[USER_NAME_MAX + 1] = "";  // Name entered for the ID being enrolled
+
+// Flags for modes
+bool enrollingMode = false; // True when enrollment is active
+bool scanningMode = false;  // True when scanning is active
+
+/* Show why the menu cannot be used yet; false once the sensor handshake has succeeded */
+static bool sensor_unavailable() {
+  switch (fp_sensor_state()) {
+    case FP_SENSOR_CONNECTING: status_show(STATUS_CONNECTING); return true;
+    case FP_SENSOR_MISSING:    status_show(STATUS_NO_SENSOR);  return true;
+    default:                   return false;
+  }
+}
+
+/* Event handler for the Return button */
+void return_button_event_handler(lv_event_t *e) {
+  lv_event_code_t code = lv_event_get_code(e); // Get the event code
+
+  if (code == LV_EVENT_CLICKED) { // If return button is clicked
+    LOG_D("Return button clicked."); // Print message to serial monitor
+
+    return_to_main_menu(); // Show the main menu and reset the modes (the service cancels the enrollment)
+  }
+}
+
+// Event handler for the Scan button (main menu)
+void scan_button_event_handler(lv_event_t *e) {
+  // Get the event code (e.g., button click)
+  lv_event_code_t code = lv_event_get_code(e);
+
+  // Check if the Scan button was clicked
+  if (code == LV_EVENT_CLICKED) {
+    if (sensor_unavailable()) return;  // Handshake still running on the service task
+    scanningMode = true;  // Set scanning mode to true
+    status_reset_counters();  // Count label updates for this scanning session
+    status_show(STATUS_SCANNING);  // Update label to show scanning status
+    ui_nav_go(UI_SCREEN_SCAN);  // Scanning screen with its Return button
+  }
+}
+
+// Event handler for the Return button of the scanning screen
+static void scan_return_event_handler(lv_event_t *e) {
+  if (lv_event_get_code(e) != LV_EVENT_CLICKED) return;
+  scanningMode = false;  // Disable scanning mode
+  LOG_D("Status label: %lu updates, %lu skipped while scanning",
+        (unsigned long)status_update_count(), (unsigned long)status_skip_count());
+  status_show(STATUS_RETURNING);  // Update label to show returning status
+  ui_nav_go(UI_SCREEN_MENU);
+}
+
+// Event handler for the Enroll button
+void enroll_button_event_handler(lv_event_t *e) {
+  // Get the event code (e.g., button click)
+  lv_event_code_t code = lv_event_get_code(e);
+
+  // If the Enroll button was clicked
+  if (code == LV_EVENT_CLICKED) {
+    if (sensor_unavailable()) return;  // No capacity or free ID known yet
+    uint16_t freeId = fp_slots_next_free();  // Suggest the lowest free ID
+    if (fp_slots_valid() && freeId == FP_SLOT_NONE) {
+      status_show(STATUS_LIBRARY_FULL);  // Nothing to enroll into
+      return;
+    }
+    status_show(STATUS_ENTER_ID);  // Update label to show enrollment process
+    LOG_D("Enroll button clicked.");  // Print message to Serial monitor for debugging
+    ui_nav_go(UI_SCREEN_ID_ENTRY);  // Built on the first enrollment since boot
+    uint16_t slots = fp_slots_capacity();  // Sensor's library, at most FP_SLOTS_MAX: taken IDs are known
+    id_keypad_set_range(FP_SLOTS_FIRST_ID, slots ? slots - 1 : 0);
+    id_keypad_set_value(freeId < slots ? freeId : 0);  // OK accepts the suggestion
+  }
+}
+
+// Event handler for the ID keypad: OK pressed with an ID in the sensor's range
+static void id_keypad_event_handler(lv_event_t *e) {
+  if (lv_event_get_code(e) != LV_EVENT_READY) return;
+  uint16_t value = id_keypad_get_value();
+
+  // The keypad only accepts IDs of the library; refuse one that already holds a template
+  if (fp_slots_occupied(value)) {
+    status_set_fmt("ID #%u is already in use.", value);  // Refuse to overwrite someone
+    return;
+  }
+  id = value;
+  status_set_fmt("Name for ID #%u:", id);  // Ask for the name next
+  ui_nav_go(UI_SCREEN_NAME_ENTRY);
+  lv_textarea_set_text(inputTextArea, "");
+}
+
+// Event handler for the on-screen keyboard: the name to show for this ID (may be left empty)
+void keyboard_event_handler(lv_event_t *e) {
+  // Get the event code (e.g., input ready)
+  lv_event_code_t code = lv_event_get_code(e);
+
+  // If the user has finished entering the name
+  if (code == LV_EVENT_READY) {
+    strncpy(enrollName, lv_textarea_get_text(inputTextArea), USER_NAME_MAX);
+    enrollName[USER_NAME_MAX] = '\0';
+    status_set_fmt("Enrolling ID #%u", id);  // Show the ID being enrolled
+    ui_nav_go(UI_SCREEN_ENROLL);  // Enrolling screen with the Return button
+    enrollingMode = true;  // Set enrolling mode to true
+  }
+}
+
+// Function to return to the main menu
+void return_to_main_menu() {
+  ui_nav_go(UI_SCREEN_MENU);  // Show the main menu buttons (Enroll and Scan)
+  status_show(STATUS_SELECT);  // Update label to prompt user action
+
+  // Reset enrollment and scanning modes
+  enrollingMode = false;
+  scanningMode = false;
+}
+
+// Function to enlarge a button (used for return button)
+void enlarge_button(lv_obj_t *button) {
+  lv_obj_set_size(button, 120, 60);  // Set button dimensions to 120x60 pixels
+  lv_obj_set_style_pad_all(button, 10, 0);  // Add 10px padding to the button
+}
+
+/* Add an enlarged Return button at the centre of a screen */
+static lv_obj_t *create_return_button(lv_obj_t *screen, lv_event_cb_t handler) {
+  lv_obj_t *button = lv_btn_create(screen);                                 // Create a Return button
+  enlarge_button(button);                                                   // Enlarge the Return button
+  lv_obj_align(button, LV_ALIGN_CENTER, 0, 40);                             // Align the Return button to the center
+  lv_obj_t *label = lv_label_create(button);                                // Create a label for the Return button
+  lv_label_set_text(label, "Return");                                       // Set the text for the Return button label
+  lv_obj_add_event_cb(button, handler, LV_EVENT_ALL, NULL);                 // Add an event handler for the Return button
+  return button;
+}
+
+/* Main menu: Scan and Enroll buttons */
+static void build_menu(lv_obj_t *screen) {
+  // Create buttons for Scan and Enroll
+  scanButton = lv_btn_create(screen);                                       // Create a Scan button
+  lv_obj_set_size(scanButton, 100, 50);                                     // Set button size to 100x50 pixels
+  lv_obj_align(scanButton, LV_ALIGN_CENTER, -80, 40);                       // Align Scan button to the center-left
+  lv_obj_t *scanButtonLabel = lv_label_create(scanButton);                  // Create a label for the Scan button
+  lv_label_set_text(scanButtonLabel, "Scan");                               // Set the text for the Scan button label
+  lv_obj_add_event_cb(scanButton, scan_button_event_handler, LV_EVENT_ALL, NULL);  // Add an event handler for the Scan button
+
+  enrollButton = lv_btn_create(screen);                                     // Create an Enroll button
+  lv_obj_set_size(enrollButton, 100, 50);                                   // Set button size to 100x50 pixels
+  lv_obj_align(enrollButton, LV_ALIGN_CENTER, 80, 40);                      // Align Enroll button to the center-right
+  lv_obj_t *enrollButtonLabel = lv_label_create(enrollButton);              // Create a label for the Enroll button
+  lv_label_set_text(enrollButtonLabel, "Enroll");                           // Set the text for the Enroll button label
+  lv_obj_add_event_cb(enrollButton, enroll_button_event_handler, LV_EVENT_ALL, NULL);  // Add an event handler for the Enroll button
+}
+
+/* Scanning: results appear in the status label, Return stops scanning */
+static void build_scan(lv_obj_t *screen) {
+  create_return_button(screen, scan_return_event_handler);
+}
+
+/* ID entry: numeric keypad with its value label */
+static void build_id_entry(lv_obj_t *screen) {
+  idKeypad = id_keypad_create(screen);
+  lv_obj_add_event_cb(idKeypad, id_keypad_event_handler, LV_EVENT_READY, NULL);
+}
+
+/* Name entry: text area and keyboard. The keyboard is one of the heaviest LVGL widgets, so this screen is only
+   built once someone actually enrolls */
+static void build_name_entry(lv_obj_t *screen) {
+  // Create a text area for user input
+  inputTextArea = lv_textarea_create(screen);                               // Create a text area
+  lv_textarea_set_one_line(inputTextArea, true);                            // Set the text area to single-line mode
+  lv_textarea_set_placeholder_text(inputTextArea, "Enter name");            // Set placeholder text for the input text area
+  lv_textarea_set_max_length(inputTextArea, USER_NAME_MAX);                 // Fits a directory record
+  lv_obj_align(inputTextArea, LV_ALIGN_CENTER, 0, -20);                     // Align the input text area to the center
+
+  // Create a keyboard for user input
+  keyboard = lv_keyboard_create(screen);                                    // Create a keyboard
+  lv_keyboard_set_textarea(keyboard, inputTextArea);                        // Link the keyboard to the input text area
+  lv_obj_add_event_cb(keyboard, keyboard_event_handler, LV_EVENT_ALL, NULL);    // Add an event handler for the keyboard
+}
+
+/* Enrolling: progress in the status label, Return cancels */
+static void build_enroll(lv_obj_t *screen) {
+  returnButton = create_return_button(screen, return_button_event_handler);
+}
+
+/* Enrollment result: the message alone until the service returns to idle */
+static void build_result(lv_obj_t *) {}
+
+static const ui_screen_build_t screenBuilders[UI_SCREEN_COUNT] = {
+  build_menu,        // UI_SCREEN_MENU
+  build_scan,        // UI_SCREEN_SCAN
+  build_id_entry,    // UI_SCREEN_ID_ENTRY
+  build_name_entry,  // UI_SCREEN_NAME_ENTRY
+  build_enroll,      // UI_SCREEN_ENROLL
+  build_result,      // UI_SCREEN_RESULT
+};
+
+/* Create the status label and the main menu on the active screen */
+void ui_create() {
+  // Create a label to display messages (fingerLabel); it moves along to every screen
+  fingerLabel = lv_label_create(lv_scr_act());  // Create a label on the active screen
+  lv_obj_align(fingerLabel, LV_ALIGN_CENTER, 0, -40);  // Align label to the center
+  status_init(fingerLabel);  // All status updates go through the change-only status component
+  status_show(STATUS_SELECT);  // Set default text for the label
+
+  ui_nav_begin(screenBuilders, fingerLabel);  // Other screens are built when first shown
+}
@@ -0,0 +1,181 @@
+/*
+Description: Render benchmark for the UI states of the fingerprint terminal. Drives the UI through the main menu,
+scanning, ID keypad, name entry, enrolling and result screens and back with the real event handlers and measures each refresh
+through a wrapper around the display driver's flush callback, so it works unchanged with the TFT driver and the
+host framebuffer. The transition figures are the cost of one ui_nav_go(). Timing a run of status label changes,
+the most frequent LVGL heap traffic, compares the allocator backends of lv_conf.h.
+*/
+
+#include <Arduino.h>
+#include "ui.h"
+#include "ui_nav.h"
+#include "id_keypad.h"
+#include "status_label.h"
+#include "ui_bench.h"
+#include "mem_monitor.h"
+
+#ifdef ARDUINO
+#define bench_now_us() micros()  // Hardware timer
+#else
+#include <chrono>
+/* Wall clock microseconds (the host shim's micros() is a virtual clock) */
+static uint32_t bench_now_us() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+static void (*origFlush)(lv_disp_drv_t *, const lv_area_t *, lv_color_t *) = NULL; // Driver's own flush callback
+static uint32_t flushCount = 0; // Flush calls since the last reset
+static uint32_t flushPx = 0;    // Pixels flushed since the last reset
+static uint32_t relabelUs = 0;  // Time of UI_BENCH_RELABELS status label changes
+
+/* Count flush calls and flushed pixels, then hand over to the real driver */
+static void bench_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p) {
+  flushCount++;
+  flushPx += lv_area_get_size(area);
+  origFlush(drv, area, color_p);
+}
+
+/* Render everything that is invalidated right now and measure it */
+static ui_bench_sample_t bench_refresh(lv_disp_t *disp) {
+  flushCount = 0;
+  flushPx = 0;
+  uint32_t start = bench_now_us();
+  lv_refr_now(disp);  // Render and flush all invalid areas
+  while (disp->driver->draw_buf->flushing) {  // Last stripe may still be on the bus (DMA)
+    if (disp->driver->wait_cb) disp->driver->wait_cb(disp->driver);
+  }
+  ui_bench_sample_t sample = {bench_now_us() - start, flushCount, flushPx};
+  return sample;
+}
+
+/* LVGL heap in use, whichever allocator backend is configured */
+static uint32_t bench_mem_used() {
+  mem_stats_t stats;
+  mem_stats_read(&stats);
+  return stats.used;
+}
+
+/* Allocator cost of the most frequent heap traffic: the status label's text buffer reallocated on every message */
+static uint32_t bench_relabels() {
+  static const char *texts[] = {"Scanning...", "No Finger Detected", "Welcome, Alice (ID #5)", "No Match Found",
+                                "Place finger to enroll as ID #17", "Remove finger and place it again."};
+  char saved[64];
+  strncpy(saved, lv_label_get_text(fingerLabel), sizeof(saved) - 1);
+  saved[sizeof(saved) - 1] = '\0';
+  uint32_t start = bench_now_us();
+  for (int i = 0; i < UI_BENCH_RELABELS; i++) {
+    lv_label_set_text(fingerLabel, texts[i % (sizeof(texts) / sizeof(texts[0]))]);
+  }
+  uint32_t us = bench_now_us() - start;
+  lv_label_set_text(fingerLabel, saved);
+  return us;
+}
+
+/* Average refresh after a keypress: alternately key and undo (press feedback and the text change) */
+static ui_bench_sample_t bench_keypresses(lv_disp_t *disp, lv_obj_t *matrix, uint16_t key, uint16_t undo) {
+  ui_bench_sample_t sum = {0, 0, 0};
+  bench_refresh(disp);  // Start from a clean screen
+  for (int i = 0; i < UI_BENCH_ITERATIONS; i++) {
+    uint16_t btn = i % 2 ? undo : key;
+    lv_btnmatrix_set_selected_btn(matrix, btn);         // What a press does to the matrix
+    lv_event_send(matrix, LV_EVENT_VALUE_CHANGED, &btn);  // And the key's action
+    ui_bench_sample_t s = bench_refresh(disp);
+    sum.us += s.us;
+    sum.flushes += s.flushes;
+    sum.px += s.px;
+  }
+  ui_bench_sample_t avg = {sum.us / UI_BENCH_ITERATIONS, sum.flushes / UI_BENCH_ITERATIONS,
+                           sum.px / UI_BENCH_ITERATIONS};
+  return avg;
+}
+
+/* Measure the transition into a state, then the average full-screen refresh in it */
+static void bench_state(lv_disp_t *disp, const char *name, ui_bench_result_t *result) {
+  result->state = name;  // ram and keypress are filled in by the caller where they apply
+  result->transition = bench_refresh(disp);  // Only what the event handler invalidated
+
+  ui_bench_sample_t sum = {0, 0, 0};
+  for (int i = 0; i < UI_BENCH_ITERATIONS; i++) {
+    lv_obj_invalidate(lv_scr_act());  // Force a full redraw
+    ui_bench_sample_t s = bench_refresh(disp);
+    sum.us += s.us;
+    sum.flushes += s.flushes;
+    sum.px += s.px;
+  }
+  result->full.us = sum.us / UI_BENCH_ITERATIONS;
+  result->full.flushes = sum.flushes / UI_BENCH_ITERATIONS;
+  result->full.px = sum.px / UI_BENCH_ITERATIONS;
+}
+
+void ui_bench_run(lv_disp_t *disp, ui_bench_result_t results[UI_BENCH_STATE_COUNT]) {
+  origFlush = disp->driver->flush_cb;  // Measure through the real driver
+  disp->driver->flush_cb = bench_flush;
+  bench_refresh(disp);                 // Start from a clean screen
+
+  // Main menu
+  bench_state(disp, "menu", &results[0]);
+
+  // Scanning: scanning screen with its Return button
+  lv_event_send(scanButton, LV_EVENT_CLICKED, NULL);
+  bench_state(disp, "scanning", &results[1]);
+  return_to_main_menu();
+  bench_refresh(disp);
+
+  // ID entry: numeric keypad (screen built here, on first use)
+  uint32_t used = bench_mem_used();
+  lv_event_send(enrollButton, LV_EVENT_CLICKED, NULL);
+  results[2].ram = bench_mem_used() - used;
+  bench_state(disp, "id-entry", &results[2]);
+  id_keypad_set_range(1, 999);  // Digits are accepted even without a sensor
+  id_keypad_set_value(0);
+  results[2].keypress = bench_keypresses(disp, idKeypad, 0, ID_KEYPAD_BACKSPACE);  // "1", backspace
+
+  // Name entry: text area and keyboard (built here)
+  id_keypad_set_value(1);
+  used = bench_mem_used();
+  lv_event_send(idKeypad, LV_EVENT_READY, NULL);
+  if (ui_nav_current() != UI_SCREEN_NAME_ENTRY) ui_nav_go(UI_SCREEN_NAME_ENTRY);  // ID 1 taken
+  results[3].ram = bench_mem_used() - used;
+  bench_state(disp, "name-entry", &results[3]);
+  results[3].keypress = bench_keypresses(disp, keyboard, 1, 11);  // "q", backspace
+
+  // Enrolling: name accepted, Return button shown
+  lv_event_send(keyboard, LV_EVENT_READY, NULL);  // No name
+  bench_state(disp, "enrolling", &results[4]);
+
+  // Result: enrollment outcome, no buttons
+  status_set("Fingerprint enrolled successfully as ID #1");
+  ui_nav_go(UI_SCREEN_RESULT);
+  bench_state(disp, "result", &results[5]);
+
+  // Back to the main menu
+  return_to_main_menu();
+  bench_state(disp, "menu-again", &results[6]);
+  relabelUs = bench_relabels();
+  bench_refresh(disp);
+  disp->driver->flush_cb = origFlush;
+}
+
+void ui_bench_print(const ui_bench_result_t results[UI_BENCH_STATE_COUNT]) {
+  Serial.printf("UI render benchmark (%d full refreshes per state)\n", UI_BENCH_ITERATIONS);
+  Serial.printf("%-10s | %28s | %28s | %17s | %6s\n", "state", "transition", "full refresh", "keypress", "RAM");
+  Serial.printf("%-10s | %10s %7s %9s | %10s %7s %9s | %8s %8s | %6s\n", "", "us", "flushes", "px", "us", "flushes",
+                "px", "us", "px", "bytes");
+  for (int i = 0; i < UI_BENCH_STATE_COUNT; i++) {
+    const ui_bench_result_t *r = &results[i];
+    Serial.printf("%-10s | %10lu %7lu %9lu | %10lu %7lu %9lu | %8lu %8lu | %6lu\n", r->state,
+                  (unsigned long)r->transition.us, (unsigned long)r->transition.flushes,
+                  (unsigned long)r->transition.px, (unsigned long)r->full.us,
+                  (unsigned long)r->full.flushes, (unsigned long)r->full.px,
+                  (unsigned long)r->keypress.us, (unsigned long)r->keypress.px, (unsigned long)r->ram);
+  }
+
+  mem_stats_t stats;
+  char line[80];
+  mem_stats_read(&stats);
+  mem_stats_format(&stats, line, sizeof(line));
+  Serial.printf("LVGL heap (%s): %s; %d status label changes in %lu us\n", mem_backend_name(), line,
+                UI_BENCH_RELABELS, (unsigned long)relabelUs);
+}
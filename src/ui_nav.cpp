@@ -0,0 +1,71 @@
+/*
+Description: Screen navigator (see ui_nav.h). lv_scr_load() invalidates the whole new screen; the load is done with
+invalidation disabled and only the areas of the widgets that come and go are invalidated afterwards.
+*/
+
+#include <Arduino.h>
+#include <lvgl.h>
+#include "ui_nav.h"
+#include "serial_log.h"
+
+static const ui_screen_build_t *builders = NULL;  // Per screen, from ui_nav_begin()
+static lv_obj_t *screens[UI_SCREEN_COUNT];        // Built screens, NULL until first shown
+static lv_obj_t *sharedObj = NULL;                // Follows every load
+static ui_screen_t current = UI_SCREEN_MENU;
+static uint32_t transitionPx = 0;
+
+/* Invalidate the area of every widget on a screen except the shared one (it has not changed) */
+static void invalidate_widgets(lv_disp_t *disp, lv_obj_t *screen) {
+  uint32_t count = lv_obj_get_child_cnt(screen);
+  for (uint32_t i = 0; i < count; i++) {
+    lv_obj_t *child = lv_obj_get_child(screen, i);
+    if (child == sharedObj || lv_obj_has_flag(child, LV_OBJ_FLAG_HIDDEN)) continue;
+    lv_area_t area;
+    lv_obj_get_coords(child, &area);
+    lv_area_increase(&area, _lv_obj_get_ext_draw_size(child), _lv_obj_get_ext_draw_size(child));  // Shadows
+    _lv_inv_area(disp, &area);  // lv_obj_invalidate() ignores widgets of a screen that is not active
+    transitionPx += lv_area_get_size(&area);
+  }
+}
+
+lv_obj_t *ui_nav_screen(ui_screen_t screen) { return screens[screen]; }
+
+ui_screen_t ui_nav_current() { return current; }
+
+uint32_t ui_nav_transition_px() { return transitionPx; }
+
+void ui_nav_begin(const ui_screen_build_t screenBuilders[UI_SCREEN_COUNT], lv_obj_t *shared) {
+  builders = screenBuilders;
+  sharedObj = shared;
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; i++) screens[i] = NULL;
+  current = UI_SCREEN_MENU;
+  screens[UI_SCREEN_MENU] = lv_scr_act();
+  builders[UI_SCREEN_MENU](screens[UI_SCREEN_MENU]);
+  if (sharedObj) lv_obj_move_background(sharedObj);  // Drawn below the widgets, as if created first
+}
+
+void ui_nav_go(ui_screen_t screen) {
+  if (screen == current) return;
+  if (!screens[screen]) {  // First visit: build it once and keep it
+    screens[screen] = lv_obj_create(NULL);
+    builders[screen](screens[screen]);
+  }
+  lv_obj_t *from = screens[current];
+  lv_obj_t *to = screens[screen];
+  lv_disp_t *disp = lv_obj_get_disp(to);
+
+  lv_disp_enable_invalidation(disp, false);  // Neither the move nor the load redraws the whole display
+  if (sharedObj) {
+    lv_obj_set_parent(sharedObj, to);
+    lv_obj_move_background(sharedObj);
+  }
+  lv_scr_load(to);
+  lv_disp_enable_invalidation(disp, true);
+
+  lv_obj_update_layout(to);  // Coordinates of a screen that has never been shown
+  transitionPx = 0;
+  invalidate_widgets(disp, from);  // Uncover the background where the old widgets were
+  invalidate_widgets(disp, to);    // Draw the new ones
+  LOG_D("Screen %d -> %d: %lu px", current, screen, (unsigned long)transitionPx);
+  current = screen;
+}
@@ -0,0 +1,178 @@
+/*
+Description: User directory on SPIFFS. The table is an 8-byte header followed by fixed 24-byte records
+  id (2, little endian, 0xFFFF = free) | name (22, NUL padded)
+A record never moves: renaming rewrites it in place, removing frees it by overwriting the ID, and new names reuse
+the lowest free record before the file grows. At boot the records are read once, in blocks, into recordOf[]
+(ID -> record number) and a bitmap of used records; after that every lookup is a single seek and read.
+*/
+
+#include <Arduino.h>
+#include <FS.h>
+#include <SPIFFS.h>
+#include "user_dir.h"
+#include "serial_log.h"
+
+#define USER_DIR_MAGIC "UDIR"
+#define USER_DIR_VERSION 1
+#define USER_DIR_HEADER_SIZE 8
+#define USER_RECORD_SIZE (2 + USER_NAME_MAX)
+#define USER_RECORD_FREE 0xFFFF     // ID of an unused record (also "no record" in the index)
+#define USER_DIR_READ_BLOCK 16      // Records read per call while building the index
+
+static_assert(USER_DIR_MAX_IDS >= FP_SLOTS_MAX, "Every ID offered for enrollment needs room for a name");
+
+static File table;                                    // Open for reading and writing while the directory is up
+static bool ready = false;                            // Table opened and indexed
+static uint16_t recordOf[USER_DIR_MAX_IDS];           // Record number of each ID, USER_RECORD_FREE if unnamed
+static uint32_t recordUsed[USER_DIR_MAX_IDS / 32];    // Bitmap of records in use
+static uint16_t records = 0;                          // Records in the file, used or free
+static uint16_t named = 0;                            // Used records
+
+/* File offset of a record */
+static uint32_t user_dir_offset(uint16_t record) {
+  return USER_DIR_HEADER_SIZE + (uint32_t)record * USER_RECORD_SIZE;
+}
+
+/* Write a whole record and commit it */
+static bool user_dir_write(uint16_t record, const uint8_t *data, size_t len) {
+  if (!table.seek(user_dir_offset(record))) return false;
+  bool ok = table.write(data, len) == len;
+  table.flush();
+  return ok;
+}
+
+/* Create an empty table */
+static bool user_dir_create() {
+  table = SPIFFS.open(USER_DIR_PATH, "w+");
+  if (!table) return false;
+  uint8_t header[USER_DIR_HEADER_SIZE] = {'U', 'D', 'I', 'R', USER_DIR_VERSION, USER_RECORD_SIZE, 0, 0};
+  bool ok = table.write(header, sizeof(header)) == sizeof(header);
+  table.flush();
+  return ok;
+}
+
+/* Open the existing table; false if it is missing or has another layout */
+static bool user_dir_open() {
+  if (!SPIFFS.exists(USER_DIR_PATH)) return false;
+  table = SPIFFS.open(USER_DIR_PATH, "r+");
+  if (!table) return false;
+  uint8_t header[USER_DIR_HEADER_SIZE];
+  if (table.read(header, sizeof(header)) == sizeof(header) && memcmp(header, USER_DIR_MAGIC, 4) == 0 &&
+      header[4] == USER_DIR_VERSION && header[5] == USER_RECORD_SIZE) {
+    return true;
+  }
+  LOG_W("User directory has an unknown layout, keeping it as .old and starting a new one.");
+  table.close();
+  SPIFFS.remove(USER_DIR_PATH ".old");
+  SPIFFS.rename(USER_DIR_PATH, USER_DIR_PATH ".old");
+  return false;
+}
+
+/* Read all records once and fill the index */
+static void user_dir_index() {
+  uint8_t block[USER_DIR_READ_BLOCK * USER_RECORD_SIZE];
+  uint32_t size = table.size();
+  records = size > USER_DIR_HEADER_SIZE ? (size - USER_DIR_HEADER_SIZE) / USER_RECORD_SIZE : 0;
+  if (records > USER_DIR_MAX_IDS) records = USER_DIR_MAX_IDS;  // Ignore a runaway tail
+
+  table.seek(USER_DIR_HEADER_SIZE);
+  for (uint16_t first = 0; first < records; first += USER_DIR_READ_BLOCK) {
+    uint16_t n = records - first < USER_DIR_READ_BLOCK ? records - first : USER_DIR_READ_BLOCK;
+    if (table.read(block, n * USER_RECORD_SIZE) != n * USER_RECORD_SIZE) {
+      records = first;  // Truncated write at the end: treat the rest as absent
+      break;
+    }
+    for (uint16_t i = 0; i < n; i++) {
+      uint16_t id = block[i * USER_RECORD_SIZE] | (block[i * USER_RECORD_SIZE + 1] << 8);
+      if (id >= USER_DIR_MAX_IDS) continue;  // Free record
+      uint16_t record = first + i;
+      if (recordOf[id] != USER_RECORD_FREE) {  // Duplicate: the later record wins
+        recordUsed[recordOf[id] / 32] &= ~(1UL << (recordOf[id] % 32));
+        named--;
+      }
+      recordOf[id] = record;
+      recordUsed[record / 32] |= 1UL << (record % 32);
+      named++;
+    }
+  }
+}
+
+/* Lowest free record, or the next one at the end of the file */
+static uint16_t user_dir_free_record() {
+  for (uint16_t word = 0; word * 32 < records; word++) {
+    if (recordUsed[word] != 0xFFFFFFFFUL) {
+      uint16_t record = word * 32 + __builtin_ctz(~recordUsed[word]);
+      if (record < records) return record;
+    }
+  }
+  return records;
+}
+
+bool user_dir_begin() {
+  ready = false;
+  if (table) table.close();
+  for (uint16_t i = 0; i < USER_DIR_MAX_IDS; i++) recordOf[i] = USER_RECORD_FREE;
+  memset(recordUsed, 0, sizeof(recordUsed));
+  records = named = 0;
+
+  if (!SPIFFS.begin(true)) {  // Mounts on first use, formats a blank partition
+    LOG_W("User directory: file system not available.");
+    return false;
+  }
+  if (!user_dir_open() && !user_dir_create()) {
+    LOG_E("User directory: cannot create " USER_DIR_PATH);
+    return false;
+  }
+  user_dir_index();
+  ready = true;
+  LOG_I("User directory: %u names in %u records", named, records);
+  return true;
+}
+
+bool user_dir_set(uint16_t id, const char *name) {
+  if (!ready || id >= USER_DIR_MAX_IDS) return false;
+  if (!name || !name[0]) return user_dir_remove(id);  // No name is the same as none
+
+  uint16_t record = recordOf[id];
+  if (record == USER_RECORD_FREE) record = user_dir_free_record();
+  if (record >= USER_DIR_MAX_IDS) return false;
+
+  uint8_t data[USER_RECORD_SIZE] = {0};
+  data[0] = id & 0xFF;
+  data[1] = id >> 8;
+  strncpy((char *)&data[2], name, USER_NAME_MAX);  // Truncated, NUL padded
+  if (!user_dir_write(record, data, sizeof(data))) return false;
+
+  if (recordOf[id] == USER_RECORD_FREE) named++;
+  recordOf[id] = record;
+  recordUsed[record / 32] |= 1UL << (record % 32);
+  if (record == records) records++;
+  return true;
+}
+
+bool user_dir_remove(uint16_t id) {
+  if (!ready || id >= USER_DIR_MAX_IDS || recordOf[id] == USER_RECORD_FREE) return false;
+  uint16_t record = recordOf[id];
+  uint8_t freeId[2] = {USER_RECORD_FREE & 0xFF, USER_RECORD_FREE >> 8};
+  if (!user_dir_write(record, freeId, sizeof(freeId))) return false;  // The stale name stays until reused
+
+  recordOf[id] = USER_RECORD_FREE;
+  recordUsed[record / 32] &= ~(1UL << (record % 32));
+  named--;
+  return true;
+}
+
+bool user_dir_get(uint16_t id, char *name, size_t len) {
+  if (!ready || id >= USER_DIR_MAX_IDS || recordOf[id] == USER_RECORD_FREE || len == 0) return false;
+  uint8_t data[USER_RECORD_SIZE];
+  if (!table.seek(user_dir_offset(recordOf[id])) || table.read(data, sizeof(data)) != sizeof(data)) return false;
+  if ((data[0] | (data[1] << 8)) != id) return false;  // Index and file disagree
+
+  size_t n = strnlen((const char *)&data[2], USER_NAME_MAX);
+  if (n >= len) n = len - 1;
+  memcpy(name, &data[2], n);
+  name[n] = '\0';
+  return true;
+}
+
+uint16_t user_dir_count() { return named; }
@@ -31,12 +31,16 @@ void setup() {
   Serial.println("\n\nAdafruit Fingerprint sensor enrollment"); // Print initial message to serial monitor
 
   // Set up hardware serial for fingerprint sensor on ESP32
-  mySerial.begin(57600, SERIAL_8N1, 25, 33); // Initialize UART1 with 57600 baud rate, 8 data bits, 1 stop bit, and no parity. TX pin = 25, RX pin = 33
-
-  // Initialize the fingerprint sensor
-  finger.begin(57600);            // Begin communication with the fingerprint sensor at 57600 baud rate
+  // The main firmware may have raised the sensor from the factory 57600 baud to 115200, so try both
+  bool found = false;
+  const uint32_t rates[] = {57600, 115200};
+  for (uint32_t rate : rates) {
+    mySerial.begin(rate, SERIAL_8N1, 25, 33); // Initialize UART1 at this rate, 8 data bits, 1 stop bit, and no parity. TX pin = 25, RX pin = 33
+    found = finger.verifyPassword();          // Verify if the fingerprint sensor is responding correctly
+    if (found) break;
+  }
 
-  if (finger.verifyPassword()) {  // Verify if the fingerprint sensor is responding correctly
+  if (found) {
     Serial.println("Found fingerprint sensor!"); // Print message if sensor is found
   } 
   else {
@@ -26,14 +26,18 @@ void setup() {
   
   Serial.println("\n\nAdafruit Fingerprint sensor test");  // Print a message indicating the start of the sensor test
 
-  // Initialize Serial2 with the specified baud rate and pins
-  mySerial.begin(57600, SERIAL_8N1, RX_PIN, TX_PIN);  // Begin communication with the fingerprint sensor at 57600 baud rate
-
-  // Initialize the fingerprint sensor
-  finger.begin(57600);                    // Begin communication with the fingerprint sensor at 57600 baud rate
-  delay(5);                               // Small delay to ensure the sensor is ready
+  // Initialize Serial2 with the specified pins; the main firmware may have raised the sensor from
+  // the factory 57600 baud to 115200, so look for it at both rates
+  bool found = false;
+  const uint32_t rates[] = {57600, 115200};
+  for (uint32_t rate : rates) {
+    mySerial.begin(rate, SERIAL_8N1, RX_PIN, TX_PIN);  // Begin communication with the fingerprint sensor at this rate
+    delay(5);                             // Small delay to ensure the sensor is ready
+    found = finger.verifyPassword();      // Verify the sensor's password
+    if (found) break;
+  }
   
-  if (finger.verifyPassword()) {          // Verify the sensor's password
+  if (found) {
     Serial.println("Found fingerprint sensor!");  // Print message if sensor is detected
   } 
   else {
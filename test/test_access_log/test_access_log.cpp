@@ -0,0 +1,174 @@
+/*
+ * Purpose: Host unit tests for the access log (src/access_log.cpp), run with `pio test -e native`.
+ * The segments are written through the file system shim into host_fs_test/ in the working directory; the clock is
+ * the virtual one of the native build.
+ */
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <Adafruit_Fingerprint.h>
+#include <unity.h>
+#include "access_log.h"
+
+#define RECORD_SIZE 16
+#define SEGMENT_PATH(n) ACCESS_LOG_PREFIX #n ".log"
+
+static access_record_t events[ACCESS_LOG_SEGMENTS * ACCESS_LOG_SEGMENT_RECORDS];  // Read back
+
+/* Size of a segment file, 0 if it does not exist */
+static size_t segment_size(const char *path) {
+  if (!SPIFFS.exists(path)) return 0;
+  File f = SPIFFS.open(path, "r");
+  size_t size = f.size();
+  f.close();
+  return size;
+}
+
+/* Log n events with IDs first, first + 1, ... */
+static void add_events(uint16_t first, uint16_t n) {
+  for (uint16_t i = 0; i < n; i++) access_log_add(FINGERPRINT_OK, first + i, 100);
+}
+
+void setUp() {
+  host_fs_set_root("host_fs_test");
+  access_log_set_quiet(false);
+  access_log_flush();  // Empty the ring left by the previous test
+  SPIFFS.format();
+  TEST_ASSERT_TRUE(access_log_begin());
+}
+
+void tearDown() {}
+
+void test_add_stays_in_ram() {
+  add_events(1, ACCESS_LOG_BATCH - 1);
+  access_log_poll();
+  TEST_ASSERT_EQUAL_UINT16(ACCESS_LOG_BATCH - 1, access_log_pending());
+  TEST_ASSERT_EQUAL_UINT32(0, segment_size(SEGMENT_PATH(0)));
+  TEST_ASSERT_EQUAL_UINT16(ACCESS_LOG_BATCH - 1, access_log_recent(events, ACCESS_LOG_BATCH));
+  TEST_ASSERT_EQUAL_UINT16(ACCESS_LOG_BATCH - 1, events[0].id);  // Newest first
+}
+
+void test_full_batch_written() {
+  add_events(1, ACCESS_LOG_BATCH);
+  access_log_poll();
+  TEST_ASSERT_EQUAL_UINT16(0, access_log_pending());
+  TEST_ASSERT_EQUAL_UINT32(ACCESS_LOG_BATCH * RECORD_SIZE, segment_size(SEGMENT_PATH(0)));
+}
+
+void test_old_events_written_after_timeout() {
+  add_events(1, 1);
+  delay(ACCESS_LOG_FLUSH_MS - 1);
+  access_log_poll();
+  TEST_ASSERT_EQUAL_UINT16(1, access_log_pending());
+  delay(1);
+  access_log_poll();
+  TEST_ASSERT_EQUAL_UINT16(0, access_log_pending());
+}
+
+void test_sequence_continues_after_restart() {
+  add_events(1, 3);
+  access_log_flush();
+  TEST_ASSERT_TRUE(access_log_begin());
+  add_events(4, 1);
+  TEST_ASSERT_EQUAL_UINT16(4, access_log_recent(events, 10));
+  TEST_ASSERT_EQUAL_UINT32(3, events[0].seq);
+  TEST_ASSERT_EQUAL_UINT8(events[1].boot + 1, events[0].boot);
+  for (uint16_t i = 0; i < 4; i++) TEST_ASSERT_EQUAL_UINT16(4 - i, events[i].id);
+}
+
+void test_torn_record_skipped() {
+  add_events(1, 2);
+  access_log_flush();
+  File f = SPIFFS.open(SEGMENT_PATH(0), "a");
+  const uint8_t torn[7] = {2, 0, 0, 0, 1, 2, 3};  // Power lost in the middle of the third record
+  f.write(torn, sizeof(torn));
+  f.close();
+
+  TEST_ASSERT_TRUE(access_log_begin());
+  TEST_ASSERT_EQUAL_UINT32(3 * RECORD_SIZE, segment_size(SEGMENT_PATH(0)));  // Padded to a whole record
+  add_events(3, 1);
+  access_log_flush();
+  TEST_ASSERT_EQUAL_UINT16(3, access_log_recent(events, 10));
+  TEST_ASSERT_EQUAL_UINT16(3, events[0].id);
+  TEST_ASSERT_EQUAL_UINT32(2, events[0].seq);
+  TEST_ASSERT_EQUAL_UINT16(2, events[1].id);
+}
+
+void test_corrupted_record_skipped() {
+  add_events(1, 3);
+  access_log_flush();
+  File f = SPIFFS.open(SEGMENT_PATH(0), "r+");
+  f.seek(RECORD_SIZE + 8);  // ID of the second record
+  f.write(0x55);
+  f.close();
+  TEST_ASSERT_EQUAL_UINT16(2, access_log_recent(events, 10));
+  TEST_ASSERT_EQUAL_UINT16(3, events[0].id);
+  TEST_ASSERT_EQUAL_UINT16(1, events[1].id);
+}
+
+void test_segments_rotate() {
+  uint32_t total = (ACCESS_LOG_SEGMENTS + 1) * ACCESS_LOG_SEGMENT_RECORDS + 5;
+  for (uint32_t i = 0; i < total; i++) {
+    access_log_add(FINGERPRINT_NOTFOUND, 0, 0);
+    access_log_poll();
+  }
+  access_log_flush();
+  // The first segment was reused and holds the newest 5 records; the others are full
+  TEST_ASSERT_EQUAL_UINT32(5 * RECORD_SIZE, segment_size(SEGMENT_PATH(1)));
+  TEST_ASSERT_EQUAL_UINT32(ACCESS_LOG_SEGMENT_RECORDS * RECORD_SIZE, segment_size(SEGMENT_PATH(0)));
+  uint16_t n = access_log_recent(events, sizeof(events) / sizeof(events[0]));
+  TEST_ASSERT_EQUAL_UINT16((ACCESS_LOG_SEGMENTS - 1) * ACCESS_LOG_SEGMENT_RECORDS + 5, n);
+  for (uint16_t i = 0; i < n; i++) TEST_ASSERT_EQUAL_UINT32(total - 1 - i, events[i].seq);  // No gaps, newest first
+
+  TEST_ASSERT_TRUE(access_log_begin());  // The newest segment is found again
+  add_events(1, 1);
+  access_log_flush();
+  TEST_ASSERT_EQUAL_UINT32(6 * RECORD_SIZE, segment_size(SEGMENT_PATH(1)));
+}
+
+void test_no_erase_while_quiet() {
+  for (uint32_t i = 0; i < ACCESS_LOG_SEGMENT_RECORDS; i++) {
+    access_log_add(FINGERPRINT_NOTFOUND, 0, 0);
+    access_log_poll();
+  }
+  access_log_flush();  // First segment full, the next write rotates
+  access_log_set_quiet(true);  // Scanning
+  add_events(1, 3);
+  TEST_ASSERT_FALSE(access_log_flush());
+  TEST_ASSERT_EQUAL_UINT16(3, access_log_pending());  // Kept in RAM
+  TEST_ASSERT_EQUAL_UINT32(0, segment_size(SEGMENT_PATH(1)));
+  access_log_set_quiet(false);
+  TEST_ASSERT_TRUE(access_log_flush());
+  TEST_ASSERT_EQUAL_UINT32(3 * RECORD_SIZE, segment_size(SEGMENT_PATH(1)));
+}
+
+void test_ring_overflow_keeps_newest() {
+  host_fs_set_root("/proc/no_such_dir");  // File system cannot be mounted: nothing can be written
+  TEST_ASSERT_FALSE(access_log_begin());
+  uint32_t before = access_log_dropped();
+  add_events(1, ACCESS_LOG_RING + 3);
+  access_log_poll();
+  TEST_ASSERT_EQUAL_UINT16(ACCESS_LOG_RING, access_log_pending());
+  TEST_ASSERT_EQUAL_UINT32(before + 3, access_log_dropped());
+  TEST_ASSERT_EQUAL_UINT16(1, access_log_recent(events, 1));
+  TEST_ASSERT_EQUAL_UINT16(ACCESS_LOG_RING + 3, events[0].id);
+
+  host_fs_set_root("host_fs_test");  // Flash back: the buffered events are written
+  TEST_ASSERT_TRUE(access_log_begin());
+  TEST_ASSERT_TRUE(access_log_flush());
+  TEST_ASSERT_EQUAL_UINT32(ACCESS_LOG_RING * RECORD_SIZE, segment_size(SEGMENT_PATH(0)));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_add_stays_in_ram);
+  RUN_TEST(test_full_batch_written);
+  RUN_TEST(test_old_events_written_after_timeout);
+  RUN_TEST(test_sequence_continues_after_restart);
+  RUN_TEST(test_torn_record_skipped);
+  RUN_TEST(test_corrupted_record_skipped);
+  RUN_TEST(test_segments_rotate);
+  RUN_TEST(test_no_erase_while_quiet);
+  RUN_TEST(test_ring_overflow_keeps_newest);
+  return UNITY_END();
+}
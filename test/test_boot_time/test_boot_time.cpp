@@ -0,0 +1,58 @@
+/*
+ * Purpose: Host unit tests for the boot-phase profiler (src/boot_time.cpp), run with `pio test -e native`.
+ * delay() advances the host's virtual clock, so phase durations are exact. The marks persist between tests.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include <string.h>
+#include "boot_time.h"
+#include "serial_log.h"
+
+static char lastLine[SERIAL_LOG_LINE_MAX];  // Last report line
+static int lines = 0;                       // Report lines written
+
+static void capture(uint8_t, const char *line) {
+  strncpy(lastLine, line, sizeof(lastLine));
+  lines++;
+}
+
+void setUp() { serial_log_set_sink(capture); }
+
+void tearDown() {}
+
+void test_phases_recorded_in_order() {
+  uint32_t start = micros();
+  delay(120);
+  boot_phase("display");
+  delay(30);
+  boot_phase("first frame");
+  TEST_ASSERT_EQUAL_INT(2, boot_phase_count());
+  TEST_ASSERT_EQUAL_STRING("display", boot_phase_at(0)->name);
+  TEST_ASSERT_EQUAL_UINT32(120000, boot_phase_at(0)->us - start);
+  TEST_ASSERT_EQUAL_UINT32(30000, boot_phase_at(1)->us - boot_phase_at(0)->us);
+  TEST_ASSERT_NULL(boot_phase_at(2));
+}
+
+void test_report_has_one_line_per_phase() {
+  lines = 0;
+  boot_report();
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_INT(2, lines);
+  TEST_ASSERT_NOT_NULL(strstr(lastLine, "first frame"));
+  TEST_ASSERT_NOT_NULL(strstr(lastLine, "30 ms"));
+}
+
+void test_marks_past_the_limit_ignored() {
+  for (int i = 0; i < BOOT_PHASES_MAX + 3; i++) boot_phase("late");
+  TEST_ASSERT_EQUAL_INT(BOOT_PHASES_MAX, boot_phase_count());
+  TEST_ASSERT_EQUAL_STRING("first frame", boot_phase_at(1)->name);  // Earlier marks kept
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_phases_recorded_in_order);
+  RUN_TEST(test_report_has_one_line_per_phase);
+  RUN_TEST(test_marks_past_the_limit_ignored);
+  return UNITY_END();
+}
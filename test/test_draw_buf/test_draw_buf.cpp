@@ -0,0 +1,49 @@
+/*
+ * Purpose: Host unit tests for the draw buffer sizing (src/draw_buf.cpp), run with `pio test -e native`: how
+ * DRAW_BUF_LINES values map to lines and which height the auto-tune keeps.
+ */
+
+#include <unity.h>
+#include "draw_buf.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_resolve_lines() {
+  TEST_ASSERT_EQUAL_UINT16(10, draw_buf_resolve(10, 240));
+  TEST_ASSERT_EQUAL_UINT16(240, draw_buf_resolve(500, 240));  // Clamped to the screen
+  TEST_ASSERT_EQUAL_UINT16(0, draw_buf_resolve(DRAW_BUF_AUTO, 240));
+}
+
+void test_resolve_fractions() {
+  TEST_ASSERT_EQUAL_UINT16(60, draw_buf_resolve(DRAW_BUF_QUARTER, 240));
+  TEST_ASSERT_EQUAL_UINT16(120, draw_buf_resolve(DRAW_BUF_HALF, 240));
+  TEST_ASSERT_EQUAL_UINT16(240, draw_buf_resolve(DRAW_BUF_FULL, 240));
+  TEST_ASSERT_EQUAL_UINT16(DRAW_BUF_FALLBACK_LINES, draw_buf_resolve(-3, 240));  // Unknown fraction
+}
+
+void test_pick_fastest_that_fits() {
+  const draw_buf_trial_t trials[] = {{10, 52000, true}, {20, 41000, true}, {40, 36000, true}, {120, 30000, false}};
+  TEST_ASSERT_EQUAL_UINT8(2, draw_buf_pick(trials, 4));
+}
+
+void test_pick_smaller_on_a_tie() {
+  const draw_buf_trial_t trials[] = {{20, 41000, true}, {30, 36500, true}, {40, 36000, true}, {60, 35900, true}};
+  TEST_ASSERT_EQUAL_UINT8(1, draw_buf_pick(trials, 4));  // Within DRAW_BUF_TUNE_TIE_PCT of 60 lines
+}
+
+void test_pick_nothing_fits() {
+  const draw_buf_trial_t trials[] = {{10, 0, false}, {20, 0, false}};
+  TEST_ASSERT_EQUAL_UINT8(2, draw_buf_pick(trials, 2));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_resolve_lines);
+  RUN_TEST(test_resolve_fractions);
+  RUN_TEST(test_pick_fastest_that_fits);
+  RUN_TEST(test_pick_smaller_on_a_tie);
+  RUN_TEST(test_pick_nothing_fits);
+  return UNITY_END();
+}
@@ -0,0 +1,410 @@
+/*
+ * Purpose: Host unit tests for the fingerprint code, run with `pio test -e native`.
+ * getFingerprintID(), the enrollment state machine and the fingerprint service are exercised against the
+ * R30x/R503 protocol emulator (src/host/fp_emulator.cpp) through the unmodified Adafruit_Fingerprint library.
+ */
+
+#include <Arduino.h>
+#include <Adafruit_Fingerprint.h>
+#include <unity.h>
+#include "enroll.h"
+#include "fp_emulator.h"
+#include "fp_search.h"
+#include "fp_slots.h"
+#include "fp_service.h"
+
+extern Adafruit_Fingerprint finger;  // Talks to sensorEmulator (host_sensor.cpp)
+
+#define USER_A 101  // Simulated finger identities
+#define USER_B 202
+
+static uint16_t matchedId;            // ID reported by getFingerprintID()
+static enroll_state_t lastState;      // Last state reported by the enrollment
+static enroll_state_t lastFailedFrom; // State that failed, if any
+
+/* Record enrollment state changes */
+static void listener(enroll_state_t state, enroll_state_t from, uint8_t code) {
+  (void)code;
+  lastState = state;
+  if (state == ENROLL_FAILED) lastFailedFrom = from;
+}
+
+/* Step the enrollment until it reaches a state or the virtual time runs out */
+static bool enroll_run_until(enroll_state_t wanted, uint32_t maxMs) {
+  uint32_t start = millis();
+  while (millis() - start < maxMs) {
+    handleFingerprintEnrollment();
+    if (enroll_state() == wanted) return true;
+    delay(5);  // One loop() iteration
+  }
+  return false;
+}
+
+/* Put a template into the emulated library and re-read the index table, as if it was stored before boot */
+static void library_store(uint16_t id, uint16_t identity) {
+  sensorEmulator.storeTemplate(id, identity);
+  fp_slots_begin();
+}
+
+/* Virtual time of one scan of an unknown finger */
+static uint32_t unknown_scan_ms() {
+  sensorEmulator.placeFinger(USER_B);
+  uint32_t start = millis();
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_NOTFOUND, getFingerprintID(&matchedId));
+  return millis() - start;
+}
+
+void setUp() {
+  sensorEmulator.reset();
+  finger.getParameters();  // Capacity for fingerSearch()
+  fp_search_set_mode(FP_SEARCH_MODE);
+  fp_slots_begin();
+  enroll_cancel();
+  enroll_set_listener(listener);
+  lastState = ENROLL_IDLE;
+  lastFailedFrom = ENROLL_IDLE;
+}
+
+void tearDown() {}
+
+void test_scan_without_finger() {
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_NOFINGER, getFingerprintID(&matchedId));
+  TEST_ASSERT_EQUAL_UINT32(1, sensorEmulator.commandCount(FINGERPRINT_GETIMAGE));
+  TEST_ASSERT_EQUAL_UINT32(0, sensorEmulator.commandCount(FINGERPRINT_SEARCH));
+}
+
+void test_scan_matches_stored_template() {
+  library_store(7, USER_A);
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, getFingerprintID(&matchedId));
+  TEST_ASSERT_EQUAL_UINT16(7, matchedId);
+  TEST_ASSERT_EQUAL_UINT16(7, finger.fingerID);
+}
+
+void test_scan_unknown_finger() {
+  library_store(7, USER_A);
+  sensorEmulator.placeFinger(USER_B);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_NOTFOUND, getFingerprintID(&matchedId));
+}
+
+void test_scan_ids_do_not_collide_with_status_codes() {
+  library_store(FINGERPRINT_NOTFOUND, USER_A);  // ID 9, the code of "no match"
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, getFingerprintID(&matchedId));
+  TEST_ASSERT_EQUAL_UINT16(FINGERPRINT_NOTFOUND, matchedId);
+}
+
+void test_scan_matches_16_bit_id() {
+  sensorEmulator.setCapacity(1000);
+  finger.getParameters();
+  library_store(777, USER_A);
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, getFingerprintID(&matchedId));
+  TEST_ASSERT_EQUAL_UINT16(777, matchedId);
+}
+
+void test_scan_reports_injected_error() {
+  sensorEmulator.placeFinger(USER_A);
+  sensorEmulator.injectError(FINGERPRINT_IMAGE2TZ, FINGERPRINT_IMAGEMESS);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_IMAGEMESS, getFingerprintID(&matchedId));
+}
+
+void test_scan_times_out_without_response() {
+  sensorEmulator.dropResponses(1);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_PACKETRECIEVEERR, finger.getImage());  // Library maps the timeout
+}
+
+void test_search_strategies_agree() {
+  library_store(3, USER_A);
+  library_store(150, USER_B);
+  const fp_search_mode_t modes[] = {FP_SEARCH_FULL, FP_SEARCH_FAST, FP_SEARCH_OCCUPIED};
+  for (fp_search_mode_t mode : modes) {
+    fp_search_set_mode(mode);
+    sensorEmulator.placeFinger(USER_A);
+    TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, getFingerprintID(&matchedId));
+    TEST_ASSERT_EQUAL_UINT16(3, matchedId);
+    sensorEmulator.placeFinger(USER_B);
+    TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, getFingerprintID(&matchedId));
+    TEST_ASSERT_EQUAL_UINT16(150, matchedId);
+    TEST_ASSERT_EQUAL_UINT16(150, finger.fingerID);
+  }
+}
+
+void test_search_occupied_ranges() {
+  library_store(3, USER_A);
+  library_store(150, USER_B);
+  TEST_ASSERT_TRUE(fp_slots_occupied(3));
+  TEST_ASSERT_FALSE(fp_slots_occupied(4));
+  TEST_ASSERT_EQUAL_UINT8(2, fp_search_range_count());  // Gap too wide to search through
+  library_store(4, USER_B);
+  TEST_ASSERT_EQUAL_UINT8(2, fp_search_range_count());  // Joins the range of ID 3
+}
+
+void test_search_empty_library_sends_no_search() {
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_NOTFOUND, getFingerprintID(&matchedId));
+  TEST_ASSERT_EQUAL_UINT32(0, sensorEmulator.commandCount(FINGERPRINT_HISPEEDSEARCH));
+}
+
+void test_search_time_independent_of_capacity() {
+  sensorEmulator.setCapacity(200);
+  finger.getParameters();
+  library_store(1, USER_A);
+  uint32_t small = unknown_scan_ms();
+  sensorEmulator.setCapacity(1000);
+  finger.getParameters();
+  fp_slots_begin();
+  TEST_ASSERT_EQUAL_UINT32(small, unknown_scan_ms());
+
+  fp_search_set_mode(FP_SEARCH_FULL);  // Plain search walks all 1000 pages
+  TEST_ASSERT_GREATER_THAN_UINT32(small, unknown_scan_ms());
+}
+
+void test_search_follows_enrollment_and_delete() {
+  enroll_start(7);
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_WAIT_REMOVE, 1000));
+  sensorEmulator.liftFinger();
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_WAIT_SECOND, 1000));
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_DONE, 1000));
+  TEST_ASSERT_TRUE(fp_slots_occupied(7));
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, getFingerprintID(&matchedId));  // Found without re-reading the index table
+  TEST_ASSERT_EQUAL_UINT16(7, matchedId);
+
+  fp_service_begin();
+  TEST_ASSERT_TRUE(fp_service_send(FP_CMD_DELETE, 7));
+  fp_result_t result;
+  TEST_ASSERT_TRUE(fp_service_receive(&result));
+  TEST_ASSERT_FALSE(fp_slots_occupied(7));
+}
+
+void test_slots_read_from_index_table() {
+  sensorEmulator.storeTemplate(1, USER_A);
+  sensorEmulator.storeTemplate(2, USER_A);
+  sensorEmulator.storeTemplate(40, USER_B);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, fp_slots_begin());
+  TEST_ASSERT_EQUAL_UINT16(3, fp_slots_count());
+  TEST_ASSERT_TRUE(fp_slots_occupied(40));
+  TEST_ASSERT_FALSE(fp_slots_occupied(39));
+  TEST_ASSERT_EQUAL_UINT16(3, fp_slots_next_free());
+}
+
+void test_slots_allocator_follows_store_and_delete() {
+  for (uint16_t i = FP_SLOTS_FIRST_ID; i < 40; i++) fp_slots_mark(i, true);
+  TEST_ASSERT_EQUAL_UINT16(40, fp_slots_next_free());  // Crosses a bitmap word
+  fp_slots_mark(7, false);
+  TEST_ASSERT_EQUAL_UINT16(7, fp_slots_next_free());   // A delete frees a lower ID
+  fp_slots_mark(7, true);
+  TEST_ASSERT_EQUAL_UINT16(40, fp_slots_next_free());
+  fp_slots_mark(7, true);                               // Storing twice is not counted twice
+  TEST_ASSERT_EQUAL_UINT16(39, fp_slots_count());
+}
+
+void test_slots_full_library() {
+  sensorEmulator.setCapacity(40);
+  finger.getParameters();
+  fp_slots_begin();
+  for (uint16_t i = 0; i < 40; i++) fp_slots_mark(i, true);
+  TEST_ASSERT_EQUAL_UINT16(FP_SLOT_NONE, fp_slots_next_free());
+}
+
+void test_slots_library_above_bitmap() {
+  sensorEmulator.setCapacity(1500);  // More slots than FP_SLOTS_MAX
+  finger.getParameters();
+  library_store(1100, USER_B);
+  TEST_ASSERT_EQUAL_UINT16(FP_SLOTS_MAX, fp_slots_capacity());
+  TEST_ASSERT_FALSE(enroll_start(1100));  // Untracked: could hold someone's template
+  TEST_ASSERT_EQUAL(ENROLL_FAILED, lastState);
+  TEST_ASSERT_EQUAL_UINT16(USER_B, sensorEmulator.templateAt(1100));
+  for (uint16_t i = FP_SLOTS_FIRST_ID; i < FP_SLOTS_MAX; i++) fp_slots_mark(i, true);
+  TEST_ASSERT_EQUAL_UINT16(FP_SLOT_NONE, fp_slots_next_free());  // Full as far as IDs are offered
+}
+
+void test_enroll_refuses_occupied_id() {
+  library_store(3, USER_B);
+  uint32_t before = sensorEmulator.totalCommands();
+  TEST_ASSERT_FALSE(enroll_start(3));
+  TEST_ASSERT_EQUAL(ENROLL_IDLE, enroll_state());
+  TEST_ASSERT_EQUAL(ENROLL_FAILED, lastState);  // Reported to the listener
+  sensorEmulator.placeFinger(USER_A);
+  enroll_run_until(ENROLL_DONE, 1000);
+  TEST_ASSERT_EQUAL_UINT32(before, sensorEmulator.totalCommands());
+  TEST_ASSERT_EQUAL_UINT16(USER_B, sensorEmulator.templateAt(3));
+}
+
+void test_enroll_stores_template() {
+  enroll_start(3);
+  TEST_ASSERT_EQUAL(ENROLL_WAIT_FIRST, enroll_state());
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_WAIT_REMOVE, 1000));
+  sensorEmulator.liftFinger();
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_WAIT_SECOND, 1000));
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_DONE, 1000));
+  TEST_ASSERT_EQUAL_UINT16(USER_A, sensorEmulator.templateAt(3));
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_IDLE, ENROLL_RESULT_MS + 100));
+  TEST_ASSERT_EQUAL(ENROLL_IDLE, lastState);
+}
+
+void test_enroll_mismatch_fails_and_retries() {
+  enroll_start(3);
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_WAIT_REMOVE, 1000));
+  sensorEmulator.liftFinger();
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_WAIT_SECOND, 1000));
+  sensorEmulator.placeFinger(USER_B);  // A different finger the second time
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_FAILED, 1000));
+  TEST_ASSERT_EQUAL(ENROLL_CREATE_MODEL, lastFailedFrom);
+  TEST_ASSERT_EQUAL_UINT16(0, sensorEmulator.templateAt(3));
+  sensorEmulator.liftFinger();
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_WAIT_FIRST, ENROLL_RESULT_MS + 100));  // Retry
+}
+
+void test_enroll_times_out() {
+  enroll_start(3);
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_TIMED_OUT, ENROLL_FINGER_TIMEOUT_MS + 1000));
+  TEST_ASSERT_TRUE(enroll_run_until(ENROLL_IDLE, ENROLL_RESULT_MS + 100));
+}
+
+void test_enroll_polls_sensor_at_poll_interval() {
+  enroll_start(3);
+  uint32_t start = millis();
+  enroll_run_until(ENROLL_DONE, 2000);  // No finger: just waits
+  uint32_t polls = sensorEmulator.commandCount(FINGERPRINT_GETIMAGE);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32((millis() - start) / ENROLL_POLL_MS + 1, polls);
+}
+
+void test_enroll_cancel_stops_sensor_traffic() {
+  enroll_start(3);
+  enroll_cancel();
+  uint32_t before = sensorEmulator.totalCommands();
+  sensorEmulator.placeFinger(USER_A);
+  enroll_run_until(ENROLL_DONE, 500);
+  TEST_ASSERT_EQUAL_UINT32(before, sensorEmulator.totalCommands());
+  TEST_ASSERT_EQUAL_UINT16(0, sensorEmulator.templateAt(3));
+}
+
+void test_service_scan_result() {
+  fp_service_begin();
+  library_store(12, USER_A);
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_TRUE(fp_service_send(FP_CMD_SCAN));
+  fp_result_t result;
+  TEST_ASSERT_TRUE(fp_service_receive(&result));
+  TEST_ASSERT_EQUAL(FP_RES_SCAN, result.type);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, result.code);
+  TEST_ASSERT_EQUAL_UINT16(12, result.id);
+}
+
+void test_service_enroll_and_delete_16_bit_id() {
+  sensorEmulator.setCapacity(1000);
+  finger.getParameters();
+  fp_slots_begin();
+  fp_service_begin();
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_TRUE(fp_service_send(FP_CMD_ENROLL, 900));
+  fp_result_t result;
+  for (uint32_t start = millis(); millis() - start < 3000 && enroll_state() != ENROLL_WAIT_REMOVE; delay(5)) {
+    fp_service_receive(&result);
+  }
+  sensorEmulator.liftFinger();
+  for (uint32_t start = millis(); millis() - start < 3000 && enroll_state() != ENROLL_WAIT_SECOND; delay(5)) {
+    fp_service_receive(&result);
+  }
+  sensorEmulator.placeFinger(USER_A);
+  for (uint32_t start = millis(); millis() - start < 3000 && enroll_state() != ENROLL_DONE; delay(5)) {
+    fp_service_receive(&result);
+  }
+  TEST_ASSERT_EQUAL_UINT16(USER_A, sensorEmulator.templateAt(900));
+  TEST_ASSERT_TRUE(fp_slots_occupied(900));
+
+  enroll_cancel();
+  while (fp_service_receive(&result)) {}  // Drop the enrollment progress
+  TEST_ASSERT_TRUE(fp_service_send(FP_CMD_DELETE, 900));
+  TEST_ASSERT_TRUE(fp_service_receive(&result));
+  TEST_ASSERT_EQUAL(FP_RES_DELETE, result.type);
+  TEST_ASSERT_EQUAL_UINT16(900, result.id);
+  TEST_ASSERT_EQUAL_UINT16(0, sensorEmulator.templateAt(900));
+}
+
+void test_service_delete_and_count() {
+  fp_service_begin();
+  library_store(1, USER_A);
+  library_store(2, USER_B);
+  TEST_ASSERT_TRUE(fp_service_send(FP_CMD_DELETE, 1));
+  TEST_ASSERT_TRUE(fp_service_send(FP_CMD_COUNT));
+  fp_result_t result;
+  TEST_ASSERT_TRUE(fp_service_receive(&result));
+  TEST_ASSERT_EQUAL(FP_RES_DELETE, result.type);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, result.code);
+  TEST_ASSERT_TRUE(fp_service_receive(&result));
+  TEST_ASSERT_EQUAL(FP_RES_COUNT, result.type);
+  TEST_ASSERT_EQUAL_UINT16(1, result.count);
+}
+
+/* Handshake as the device runs it on the service task */
+static bool connect_ok() {
+  return finger.verifyPassword() && finger.getParameters() == FINGERPRINT_OK && fp_slots_begin() == FINGERPRINT_OK;
+}
+
+static bool connect_fails() { return false; }
+
+void test_service_handshake_before_commands() {
+  fp_service_begin(connect_ok);
+  TEST_ASSERT_EQUAL(FP_SENSOR_CONNECTING, fp_sensor_state());
+  library_store(3, USER_A);
+  sensorEmulator.placeFinger(USER_A);
+  TEST_ASSERT_TRUE(fp_service_send(FP_CMD_SCAN));  // Queued while the handshake runs
+  fp_result_t result;
+  TEST_ASSERT_TRUE(fp_service_receive(&result));
+  TEST_ASSERT_EQUAL(FP_RES_READY, result.type);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_OK, result.code);
+  TEST_ASSERT_EQUAL(FP_SENSOR_READY, fp_sensor_state());
+  TEST_ASSERT_TRUE(fp_service_receive(&result));
+  TEST_ASSERT_EQUAL(FP_RES_SCAN, result.type);
+  TEST_ASSERT_EQUAL_UINT16(3, result.id);
+}
+
+void test_service_handshake_failure() {
+  fp_service_begin(connect_fails);
+  TEST_ASSERT_TRUE(fp_service_send(FP_CMD_COUNT));
+  fp_result_t result;
+  TEST_ASSERT_TRUE(fp_service_receive(&result));
+  TEST_ASSERT_EQUAL(FP_RES_READY, result.type);
+  TEST_ASSERT_EQUAL_UINT8(FINGERPRINT_PACKETRECIEVEERR, result.code);
+  TEST_ASSERT_EQUAL(FP_SENSOR_MISSING, fp_sensor_state());
+  TEST_ASSERT_FALSE(fp_service_receive(&result));  // The count is never answered
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_scan_without_finger);
+  RUN_TEST(test_scan_matches_stored_template);
+  RUN_TEST(test_scan_unknown_finger);
+  RUN_TEST(test_scan_ids_do_not_collide_with_status_codes);
+  RUN_TEST(test_scan_matches_16_bit_id);
+  RUN_TEST(test_scan_reports_injected_error);
+  RUN_TEST(test_scan_times_out_without_response);
+  RUN_TEST(test_search_strategies_agree);
+  RUN_TEST(test_search_occupied_ranges);
+  RUN_TEST(test_search_empty_library_sends_no_search);
+  RUN_TEST(test_search_time_independent_of_capacity);
+  RUN_TEST(test_search_follows_enrollment_and_delete);
+  RUN_TEST(test_slots_read_from_index_table);
+  RUN_TEST(test_slots_allocator_follows_store_and_delete);
+  RUN_TEST(test_slots_full_library);
+  RUN_TEST(test_slots_library_above_bitmap);
+  RUN_TEST(test_enroll_refuses_occupied_id);
+  RUN_TEST(test_enroll_stores_template);
+  RUN_TEST(test_enroll_mismatch_fails_and_retries);
+  RUN_TEST(test_enroll_times_out);
+  RUN_TEST(test_enroll_polls_sensor_at_poll_interval);
+  RUN_TEST(test_enroll_cancel_stops_sensor_traffic);
+  RUN_TEST(test_service_scan_result);
+  RUN_TEST(test_service_enroll_and_delete_16_bit_id);
+  RUN_TEST(test_service_delete_and_count);
+  RUN_TEST(test_service_handshake_before_commands);
+  RUN_TEST(test_service_handshake_failure);
+  return UNITY_END();
+}
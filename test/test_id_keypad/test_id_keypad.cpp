@@ -0,0 +1,56 @@
+/*
+ * Purpose: Host unit tests for the key handling of the ID keypad (src/id_keypad.cpp), run with `pio test -e native`.
+ * Key indices follow the keypad map: 0-8 are the digits 1-9, then backspace, 0 and OK.
+ */
+
+#include <unity.h>
+#include "id_keypad.h"
+
+#define KEY_0 10  // Button index of the "0" key
+
+/* Type a sequence of keys into an empty entry */
+static uint16_t type(const uint16_t *keys, int count, uint16_t maxId) {
+  uint16_t value = 0;
+  for (int i = 0; i < count; i++) value = id_keypad_apply(value, keys[i], maxId);
+  return value;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_digits_build_the_id() {
+  const uint16_t keys[] = {0, KEY_0, 4};  // "1", "0", "5"
+  TEST_ASSERT_EQUAL_UINT16(105, type(keys, 3, 999));
+}
+
+void test_no_leading_zero() {
+  const uint16_t keys[] = {KEY_0, KEY_0, 6};  // "0", "0", "7"
+  TEST_ASSERT_EQUAL_UINT16(7, type(keys, 3, 999));
+}
+
+void test_digit_past_capacity_refused() {
+  const uint16_t keys[] = {1, 0, 8, 2};  // "2", "1", "9", "3" with IDs up to 199
+  TEST_ASSERT_EQUAL_UINT16(21, type(keys, 4, 199));
+  TEST_ASSERT_EQUAL_UINT16(199, id_keypad_apply(19, 8, 199));  // Exactly the last ID
+}
+
+void test_backspace() {
+  TEST_ASSERT_EQUAL_UINT16(12, id_keypad_apply(123, ID_KEYPAD_BACKSPACE, 999));
+  TEST_ASSERT_EQUAL_UINT16(0, id_keypad_apply(0, ID_KEYPAD_BACKSPACE, 999));
+}
+
+void test_largest_16_bit_id() {
+  TEST_ASSERT_EQUAL_UINT16(65535, id_keypad_apply(6553, 4, 65535));
+  TEST_ASSERT_EQUAL_UINT16(6553, id_keypad_apply(6553, 5, 65535));  // 65536 does not fit
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_digits_build_the_id);
+  RUN_TEST(test_no_leading_zero);
+  RUN_TEST(test_digit_past_capacity_refused);
+  RUN_TEST(test_backspace);
+  RUN_TEST(test_largest_16_bit_id);
+  return UNITY_END();
+}
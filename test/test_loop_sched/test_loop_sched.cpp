@@ -0,0 +1,62 @@
+/*
+ * Purpose: Host unit tests for the main loop scheduler's plan (src/loop_sched.cpp), run with `pio test -e native`.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "loop_sched.h"
+
+#define NO_TIMER 0xFFFFFFFF  // LV_NO_TIMER_READY
+
+static bool lightSleep;
+
+void setUp() { loop_sched_begin(-1); }
+
+void tearDown() {}
+
+void test_waits_for_the_lvgl_deadline() {
+  TEST_ASSERT_EQUAL_UINT32(17, loop_sched_plan(17, false, 0, &lightSleep));
+  TEST_ASSERT_FALSE(lightSleep);
+}
+
+void test_wait_clamped() {
+  TEST_ASSERT_EQUAL_UINT32(LOOP_MIN_WAIT_MS, loop_sched_plan(0, false, 0, &lightSleep));  // Timer already due
+  TEST_ASSERT_EQUAL_UINT32(LOOP_MAX_WAIT_MS, loop_sched_plan(500, false, 0, &lightSleep));
+  TEST_ASSERT_EQUAL_UINT32(LOOP_MAX_WAIT_MS, loop_sched_plan(NO_TIMER, false, 0, &lightSleep));
+}
+
+void test_no_light_sleep_without_penirq() {
+  TEST_ASSERT_EQUAL_UINT32(LOOP_MAX_WAIT_MS, loop_sched_plan(NO_TIMER, true, LOOP_IDLE_SLEEP_MS * 10, &lightSleep));
+  TEST_ASSERT_FALSE(lightSleep);  // A touch could not wake it
+}
+
+void test_light_sleep_on_idle_menu() {
+  TEST_ASSERT_TRUE(loop_sched_begin(4));
+  loop_sched_plan(20, true, LOOP_IDLE_SLEEP_MS - 1, &lightSleep);
+  TEST_ASSERT_FALSE(lightSleep);  // Recently touched
+  TEST_ASSERT_EQUAL_UINT32(LOOP_LIGHT_SLEEP_MS, loop_sched_plan(20, true, LOOP_IDLE_SLEEP_MS, &lightSleep));
+  TEST_ASSERT_TRUE(lightSleep);
+}
+
+void test_no_light_sleep_while_scanning() {
+  loop_sched_begin(4);
+  TEST_ASSERT_EQUAL_UINT32(20, loop_sched_plan(20, false, LOOP_IDLE_SLEEP_MS * 10, &lightSleep));
+  TEST_ASSERT_FALSE(lightSleep);  // Results arrive without a touch on the panel
+}
+
+void test_host_sleep_advances_clock() {
+  uint32_t start = millis();
+  TEST_ASSERT_FALSE(loop_sched_sleep(12, false));
+  TEST_ASSERT_EQUAL_UINT32(12, millis() - start);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_waits_for_the_lvgl_deadline);
+  RUN_TEST(test_wait_clamped);
+  RUN_TEST(test_no_light_sleep_without_penirq);
+  RUN_TEST(test_light_sleep_on_idle_menu);
+  RUN_TEST(test_no_light_sleep_while_scanning);
+  RUN_TEST(test_host_sleep_advances_clock);
+  return UNITY_END();
+}
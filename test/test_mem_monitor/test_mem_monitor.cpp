@@ -0,0 +1,66 @@
+/*
+ * Purpose: Host unit tests for the LVGL heap monitor (src/mem_monitor.cpp) and the counting heap backend
+ * (src/lv_mem_port.cpp), run with `pio test -e native`.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <lvgl.h>
+#include "mem_monitor.h"
+#include "lv_mem_port.h"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_fragmentation() {
+  TEST_ASSERT_EQUAL_UINT8(0, mem_frag_pct(0, 0));          // Nothing free
+  TEST_ASSERT_EQUAL_UINT8(0, mem_frag_pct(4096, 4096));    // One free block
+  TEST_ASSERT_EQUAL_UINT8(50, mem_frag_pct(4096, 2048));
+  TEST_ASSERT_EQUAL_UINT8(99, mem_frag_pct(100000, 1000));
+}
+
+void test_format() {
+  mem_stats_t stats = {49152, 12595, 20582, 36557, 30924, 15};
+  char line[80];
+  mem_stats_format(&stats, line, sizeof(line));
+  TEST_ASSERT_EQUAL_STRING("12.2/48.0 kB, max 20.0 kB, frag 15%, largest 30.1 kB", line);
+}
+
+void test_heap_backend_counts_blocks() {
+  uint32_t used = lv_mem_port_used();
+  uint8_t *p = (uint8_t *)lv_mem_port_malloc(100);
+  TEST_ASSERT_NOT_NULL(p);
+  memset(p, 0xA5, 100);  // Whole block writable, size prefix untouched
+  TEST_ASSERT_EQUAL_UINT32(used + 100, lv_mem_port_used());
+
+  p = (uint8_t *)lv_mem_port_realloc(p, 300);
+  TEST_ASSERT_EQUAL_UINT8(0xA5, p[99]);  // Contents kept
+  TEST_ASSERT_EQUAL_UINT32(used + 300, lv_mem_port_used());
+  TEST_ASSERT_TRUE(lv_mem_port_max_used() >= used + 300);
+
+  lv_mem_port_free(p);
+  lv_mem_port_free(NULL);
+  TEST_ASSERT_EQUAL_UINT32(used, lv_mem_port_used());
+}
+
+void test_allocation_seen_by_monitor() {
+  mem_stats_t before, after;
+  mem_stats_read(&before);
+  void *p = lv_mem_alloc(2000);
+  mem_stats_read(&after);
+  TEST_ASSERT_TRUE(after.used >= before.used + 2000);  // Pool backends add their block header
+  TEST_ASSERT_TRUE(after.maxUsed >= after.used);
+  TEST_ASSERT_TRUE(after.largestFree <= after.freeBytes);
+  lv_mem_free(p);
+}
+
+int main() {
+  lv_init();
+  UNITY_BEGIN();
+  RUN_TEST(test_fragmentation);
+  RUN_TEST(test_format);
+  RUN_TEST(test_heap_backend_counts_blocks);
+  RUN_TEST(test_allocation_seen_by_monitor);
+  return UNITY_END();
+}
@@ -0,0 +1,126 @@
+/*
+ * Purpose: Host unit tests for the serial log (src/serial_log.cpp), run with `pio test -e native`.
+ * Lines are captured with a sink instead of going to stdout; the host has no writer task, so the tests drain the
+ * ring themselves, with the virtual clock standing in for the time between two runs of the task.
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "serial_log.h"
+
+#define CAPTURE_MAX 64
+
+static char captured[CAPTURE_MAX][SERIAL_LOG_LINE_MAX];  // Lines that reached the sink
+static uint8_t capturedLevel[CAPTURE_MAX];
+static int capturedCount = 0;
+
+static void capture(uint8_t level, const char *line) {
+  if (capturedCount == CAPTURE_MAX) return;
+  capturedLevel[capturedCount] = level;
+  strncpy(captured[capturedCount++], line, SERIAL_LOG_LINE_MAX);
+}
+
+void setUp() {
+  serial_log_set_sink(capture);
+  serial_log_set_level(SERIAL_LOG_LEVEL);
+  static int test = 0;
+  LOG_E("test %d", ++test);  // A line no test repeats ends any run of repeats
+  serial_log_drain();
+  delay(1000);  // Refill the rate limit
+  capturedCount = 0;
+}
+
+void tearDown() {}
+
+void test_lines_written_in_order() {
+  LOG_I("first %d", 1);
+  LOG_W("second");
+  TEST_ASSERT_EQUAL_INT(0, capturedCount);  // Nothing written before the drain
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_INT(2, capturedCount);
+  TEST_ASSERT_EQUAL_STRING("first 1", captured[0]);
+  TEST_ASSERT_EQUAL_STRING("second", captured[1]);
+  TEST_ASSERT_EQUAL_UINT8(SERIAL_LOG_WARN, capturedLevel[1]);
+}
+
+void test_debug_compiled_out_by_default() {
+  LOG_D("debug");
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_INT(SERIAL_LOG_LEVEL >= SERIAL_LOG_DEBUG ? 1 : 0, capturedCount);
+}
+
+void test_runtime_level() {
+  serial_log_set_level(SERIAL_LOG_WARN);
+  LOG_I("info");
+  LOG_W("warning");
+  LOG_E("error");
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_INT(2, capturedCount);
+  TEST_ASSERT_EQUAL_STRING("warning", captured[0]);
+  TEST_ASSERT_EQUAL_UINT8(SERIAL_LOG_WARN, serial_log_level());
+}
+
+void test_repeats_collapsed() {
+  for (int i = 0; i < 10; i++) LOG_I("No Match Found");
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_INT(1, capturedCount);  // The run is still going
+  delay(SERIAL_LOG_REPEAT_MS);
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_INT(2, capturedCount);
+  TEST_ASSERT_EQUAL_STRING("(last line repeated 9 times)", captured[1]);
+
+  LOG_I("No Match Found");
+  LOG_I("Fingerprint ID: 5");  // A different line ends the run at once
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_INT(4, capturedCount);
+  TEST_ASSERT_EQUAL_STRING("(last line repeated 1 times)", captured[2]);
+  TEST_ASSERT_EQUAL_STRING("Fingerprint ID: 5", captured[3]);
+}
+
+void test_rate_limited() {
+  uint32_t dropped = serial_log_dropped();
+  for (int i = 0; i < SERIAL_LOG_RATE + 5; i++) LOG_I("line %d", i);
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_INT(SERIAL_LOG_RATE, capturedCount);
+  TEST_ASSERT_EQUAL_UINT32(dropped + 5, serial_log_dropped());
+
+  delay(1000);  // A second later the drop is reported
+  LOG_I("after");
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_STRING("(5 lines over the rate limit dropped)", captured[SERIAL_LOG_RATE]);
+  TEST_ASSERT_EQUAL_STRING("after", captured[SERIAL_LOG_RATE + 1]);
+}
+
+void test_full_ring_drops_newest() {
+  uint32_t dropped = serial_log_dropped();
+  for (int i = 0; i < SERIAL_LOG_SLOTS + 3; i++) LOG_I("line %d", i);
+  TEST_ASSERT_EQUAL_UINT32(dropped + 3, serial_log_dropped());
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_STRING("line 0", captured[0]);  // The oldest lines were kept
+
+  LOG_I("after");  // The ring is usable again
+  delay(1000);
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_STRING("after", captured[capturedCount - 1]);
+}
+
+void test_long_line_cut() {
+  char text[2 * SERIAL_LOG_LINE_MAX];
+  memset(text, 'x', sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+  LOG_I("%s", text);
+  serial_log_drain();
+  TEST_ASSERT_EQUAL_UINT32(SERIAL_LOG_LINE_MAX - 1, strlen(captured[0]));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_lines_written_in_order);
+  RUN_TEST(test_debug_compiled_out_by_default);
+  RUN_TEST(test_runtime_level);
+  RUN_TEST(test_repeats_collapsed);
+  RUN_TEST(test_rate_limited);
+  RUN_TEST(test_full_ring_drops_newest);
+  RUN_TEST(test_long_line_cut);
+  return UNITY_END();
+}
@@ -0,0 +1,65 @@
+/*
+ * Purpose: Host unit tests for the touch calibration record (src/touch_cal.cpp), run with `pio test -e native`.
+ * The native build keeps the record in RAM, so these check the encoding and which records are rejected.
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "touch_cal.h"
+#include "crc16.h"
+
+static const uint16_t CAL[TOUCH_CAL_VALUES] = {312, 3480, 285, 3502, 7};  // Typical XPT2046 values
+static uint8_t record[TOUCH_CAL_RECORD_SIZE];
+static uint16_t cal[TOUCH_CAL_VALUES];
+
+void setUp() {
+  memset(cal, 0, sizeof(cal));
+  touch_cal_encode(CAL, 1, record);
+}
+
+void tearDown() {}
+
+void test_record_round_trip() {
+  TEST_ASSERT_EQUAL_INT(TOUCH_CAL_RECORD_SIZE, touch_cal_encode(CAL, 1, record));
+  TEST_ASSERT_TRUE(touch_cal_decode(record, sizeof(record), 1, cal));
+  TEST_ASSERT_EQUAL_MEMORY(CAL, cal, sizeof(cal));
+}
+
+void test_corrupted_record_rejected() {
+  for (size_t i = 0; i < sizeof(record); i++) {  // Any single flipped bit is caught by the CRC
+    record[i] ^= 0x10;
+    TEST_ASSERT_FALSE(touch_cal_decode(record, sizeof(record), 1, cal));
+    record[i] ^= 0x10;
+  }
+  TEST_ASSERT_FALSE(touch_cal_decode(record, sizeof(record) - 1, 1, cal));  // Short read
+}
+
+void test_other_rotation_rejected() {
+  TEST_ASSERT_FALSE(touch_cal_decode(record, sizeof(record), 3, cal));
+  TEST_ASSERT_EQUAL_UINT16(0, cal[0]);  // Output untouched
+}
+
+void test_other_version_rejected() {
+  record[2] = TOUCH_CAL_VERSION + 1;  // A later layout, with its CRC redone so only the version differs
+  uint16_t crc = crc16_ccitt(record, TOUCH_CAL_RECORD_SIZE - 2);
+  record[TOUCH_CAL_RECORD_SIZE - 2] = crc & 0xFF;
+  record[TOUCH_CAL_RECORD_SIZE - 1] = crc >> 8;
+  TEST_ASSERT_FALSE(touch_cal_decode(record, sizeof(record), 1, cal));
+}
+
+void test_save_then_load() {
+  TEST_ASSERT_TRUE(touch_cal_save(CAL, 1));
+  TEST_ASSERT_TRUE(touch_cal_load(1, cal));
+  TEST_ASSERT_EQUAL_MEMORY(CAL, cal, sizeof(cal));
+  TEST_ASSERT_FALSE(touch_cal_load(0, cal));  // Display rotated since: calibrate again
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_record_round_trip);
+  RUN_TEST(test_corrupted_record_rejected);
+  RUN_TEST(test_other_rotation_rejected);
+  RUN_TEST(test_other_version_rejected);
+  RUN_TEST(test_save_then_load);
+  return UNITY_END();
+}
@@ -0,0 +1,141 @@
+/*
+ * Purpose: Host unit tests for the touch sample pipeline (src/touch_filter.cpp), run with `pio test -e native`.
+ * Each trace is a sequence of polls of 5 readings {x, y, z} in screen coordinates, shaped like XPT2046 output:
+ * pressure ramps at the edges of a press, single bad conversions and a few pixels of noise.
+ */
+
+#include <unity.h>
+#include <stdlib.h>
+#include "touch_filter.h"
+
+#define READINGS 5  // Readings per poll in the traces
+
+typedef touch_sample_t poll_t[READINGS];
+
+static touch_filter_t filter;
+static int16_t x, y;
+
+/* Feed a trace; returns the number of polls reported as pressed */
+static int feed(const poll_t *trace, int polls) {
+  int pressedPolls = 0;
+  for (int i = 0; i < polls; i++) {
+    if (touch_filter_update(&filter, trace[i], READINGS, &x, &y)) pressedPolls++;
+  }
+  return pressedPolls;
+}
+
+/* A poll of five readings at (px, py) with pressure z */
+static void steady(touch_sample_t *poll, int16_t px, int16_t py, uint16_t z) {
+  for (int i = 0; i < READINGS; i++) poll[i] = {px, py, z};
+}
+
+void setUp() { touch_filter_init(&filter); }
+
+void tearDown() {}
+
+void test_idle_panel() {
+  static const poll_t idle[3] = {};
+  TEST_ASSERT_EQUAL_INT(0, feed(idle, 3));
+}
+
+void test_single_noisy_poll_is_no_click() {
+  static const poll_t trace[] = {
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{212, 97, 820}, {214, 95, 900}, {210, 99, 780}, {213, 96, 700}, {0, 0, 0}},  // Brushed for one poll
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+  };
+  TEST_ASSERT_EQUAL_INT(0, feed(trace, 4));
+}
+
+void test_tap_with_bad_conversions() {
+  static const poll_t trace[] = {
+    {{0, 0, 0}, {101, 51, 380}, {99, 49, 520}, {100, 50, 640}, {102, 50, 700}},      // Pressure ramping up
+    {{100, 50, 900}, {319, 0, 910}, {101, 49, 950}, {99, 51, 930}, {100, 50, 920}},  // One conversion off screen
+    {{100, 51, 950}, {99, 50, 940}, {100, 239, 960}, {101, 50, 955}, {100, 49, 950}},
+    {{99, 50, 930}, {100, 50, 935}, {100, 50, 940}, {0, 120, 945}, {101, 51, 925}},
+    {{100, 50, 600}, {100, 50, 420}, {0, 0, 200}, {0, 0, 0}, {0, 0, 0}},  // Lifting
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+    {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}, {0, 0, 0}},
+  };
+  int16_t worst = 0;
+  for (int i = 0; i < 4; i++) {
+    if (touch_filter_update(&filter, trace[i], READINGS, &x, &y)) {
+      int16_t d = abs(x - 100) > abs(y - 50) ? abs(x - 100) : abs(y - 50);
+      if (d > worst) worst = d;
+    }
+  }
+  TEST_ASSERT_TRUE(filter.pressed);
+  TEST_ASSERT_INT_WITHIN(1, 0, worst);  // The bad conversions never reach the pointer
+  TEST_ASSERT_EQUAL_INT(1, feed(&trace[4], 3));  // Released after TOUCH_RELEASE_POLLS quiet polls
+  TEST_ASSERT_FALSE(filter.pressed);
+}
+
+void test_pressure_dip_keeps_press() {
+  static poll_t trace[8];
+  for (int i = 0; i < 8; i++) steady(trace[i], 160, 120, 900);
+  steady(trace[4], 160, 120, 450);  // Between the thresholds: does not end a press
+  steady(trace[5], 160, 120, 100);  // One light poll: debounced
+  TEST_ASSERT_EQUAL_INT(7, feed(trace, 8));  // Pressed from the second poll on, without a release
+}
+
+void test_light_touch_does_not_press() {
+  static poll_t trace[6];
+  for (int i = 0; i < 6; i++) steady(trace[i], 160, 120, 450);  // Below TOUCH_Z_PRESS
+  TEST_ASSERT_EQUAL_INT(0, feed(trace, 6));
+}
+
+void test_jitter_smoothed() {
+  static const int8_t noise[][2] = {{3, -2}, {-3, 2}, {2, 3}, {-2, -3}, {3, 1}, {-3, -1}, {1, 3}, {-1, -3}};
+  static poll_t trace[2 + 8];
+  steady(trace[0], 200, 100, 900);
+  steady(trace[1], 200, 100, 900);
+  for (int i = 0; i < 8; i++) steady(trace[2 + i], 200 + noise[i][0], 100 + noise[i][1], 900);
+  feed(trace, 2);
+  int16_t worst = 0;
+  for (int i = 2; i < 10; i++) {
+    touch_filter_update(&filter, trace[i], READINGS, &x, &y);
+    int16_t d = abs(x - 200) > abs(y - 100) ? abs(x - 200) : abs(y - 100);
+    if (d > worst) worst = d;
+  }
+  TEST_ASSERT_INT_WITHIN(2, 0, worst);  // Input moves by up to 3 pixels every poll
+}
+
+void test_drag_followed() {
+  static poll_t trace[2 + 10 + 4];
+  steady(trace[0], 20, 120, 900);
+  steady(trace[1], 20, 120, 900);
+  for (int i = 0; i < 10; i++) steady(trace[2 + i], 20 + 10 * (i + 1), 120, 900);  // 10 px per poll
+  for (int i = 12; i < 16; i++) steady(trace[i], 120, 120, 900);                   // Stops at x = 120
+  feed(trace, 12);
+  TEST_ASSERT_INT_WITHIN(10, 120, x);  // At most one poll behind
+  feed(&trace[12], 4);
+  TEST_ASSERT_INT_WITHIN(1, 120, x);
+  TEST_ASSERT_EQUAL_INT16(120, y);
+}
+
+void test_new_press_starts_at_its_position() {
+  static poll_t trace[2 + 2 + 2];
+  steady(trace[0], 40, 40, 900);
+  steady(trace[1], 40, 40, 900);
+  steady(trace[2], 0, 0, 0);
+  steady(trace[3], 0, 0, 0);
+  steady(trace[4], 280, 200, 900);
+  steady(trace[5], 280, 200, 900);
+  TEST_ASSERT_EQUAL_INT(3, feed(trace, 6));  // Polls 2-3 (release debounced) and 6
+  TEST_ASSERT_EQUAL_INT16(280, x);
+  TEST_ASSERT_EQUAL_INT16(200, y);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_idle_panel);
+  RUN_TEST(test_single_noisy_poll_is_no_click);
+  RUN_TEST(test_tap_with_bad_conversions);
+  RUN_TEST(test_pressure_dip_keeps_press);
+  RUN_TEST(test_light_touch_does_not_press);
+  RUN_TEST(test_jitter_smoothed);
+  RUN_TEST(test_drag_followed);
+  RUN_TEST(test_new_press_starts_at_its_position);
+  return UNITY_END();
+}
@@ -0,0 +1,62 @@
+/*
+ * Purpose: Host unit tests for the trace ring (src/trace.cpp), run with `pio test -e native`.
+ * The TRACE_* macros are compiled out without TRACE_ENABLED, so the tests record through trace_point().
+ */
+
+#include <Arduino.h>
+#include <unity.h>
+#include "trace.h"
+
+static trace_record_t records[TRACE_RING];
+
+void setUp() { trace_clear(); }
+
+void tearDown() {}
+
+void test_empty() {
+  TEST_ASSERT_EQUAL_UINT16(0, trace_read(records, TRACE_RING));
+}
+
+void test_records_in_order() {
+  trace_point(TRACE_SCAN, 'B', 0);
+  delay(3);
+  trace_point(TRACE_GET_IMAGE, 'B', 0);
+  delay(2);
+  trace_point(TRACE_GET_IMAGE, 'E', 2);
+  TEST_ASSERT_EQUAL_UINT16(3, trace_read(records, TRACE_RING));
+  TEST_ASSERT_EQUAL_UINT8(TRACE_SCAN, records[0].event);
+  TEST_ASSERT_EQUAL_INT('E', records[2].phase);
+  TEST_ASSERT_EQUAL_UINT8(2, records[2].arg);
+  TEST_ASSERT_EQUAL_UINT32(3000, records[1].us - records[0].us);  // Microseconds
+  TEST_ASSERT_EQUAL_UINT32(2000, records[2].us - records[1].us);
+}
+
+void test_full_ring_keeps_newest() {
+  for (uint16_t i = 0; i < TRACE_RING + 10; i++) trace_point(TRACE_LVGL, 'I', i & 0xFF);
+  TEST_ASSERT_EQUAL_UINT16(TRACE_RING, trace_read(records, TRACE_RING));
+  TEST_ASSERT_EQUAL_UINT8(10, records[0].arg);
+  TEST_ASSERT_EQUAL_UINT8((TRACE_RING + 9) & 0xFF, records[TRACE_RING - 1].arg);
+}
+
+void test_read_limited_to_newest() {
+  for (uint8_t i = 0; i < 5; i++) trace_point(TRACE_FLUSH, 'I', i);
+  TEST_ASSERT_EQUAL_UINT16(2, trace_read(records, 2));
+  TEST_ASSERT_EQUAL_UINT8(3, records[0].arg);
+  TEST_ASSERT_EQUAL_UINT8(4, records[1].arg);
+}
+
+void test_event_names() {
+  TEST_ASSERT_EQUAL_STRING("getImage", trace_event_name(TRACE_GET_IMAGE));
+  TEST_ASSERT_EQUAL_STRING("result", trace_event_name(TRACE_RESULT));
+  TEST_ASSERT_EQUAL_STRING("?", trace_event_name(TRACE_EVENT_COUNT));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty);
+  RUN_TEST(test_records_in_order);
+  RUN_TEST(test_full_ring_keeps_newest);
+  RUN_TEST(test_read_limited_to_newest);
+  RUN_TEST(test_event_names);
+  return UNITY_END();
+}
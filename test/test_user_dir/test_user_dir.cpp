@@ -0,0 +1,130 @@
+/*
+ * Purpose: Host unit tests for the user directory (src/user_dir.cpp), run with `pio test -e native`.
+ * The table is written through the file system shim into host_fs_test/ in the working directory.
+ */
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <unity.h>
+#include "user_dir.h"
+
+#define RECORD_SIZE (2 + USER_NAME_MAX)  // Fixed record size of the table
+#define HEADER_SIZE 8
+
+static char name[USER_NAME_MAX + 1];  // Lookup result
+
+/* Size of the table file */
+static size_t table_size() {
+  File f = SPIFFS.open(USER_DIR_PATH, "r");
+  size_t size = f.size();
+  f.close();
+  return size;
+}
+
+void setUp() {
+  host_fs_set_root("host_fs_test");
+  SPIFFS.format();
+  TEST_ASSERT_TRUE(user_dir_begin());
+}
+
+void tearDown() {}
+
+void test_set_and_get() {
+  TEST_ASSERT_TRUE(user_dir_set(5, "Alice"));
+  TEST_ASSERT_TRUE(user_dir_set(900, "Bob"));
+  TEST_ASSERT_TRUE(user_dir_get(5, name, sizeof(name)));
+  TEST_ASSERT_EQUAL_STRING("Alice", name);
+  TEST_ASSERT_TRUE(user_dir_get(900, name, sizeof(name)));
+  TEST_ASSERT_EQUAL_STRING("Bob", name);
+  TEST_ASSERT_FALSE(user_dir_get(6, name, sizeof(name)));
+  TEST_ASSERT_EQUAL_UINT16(2, user_dir_count());
+}
+
+void test_index_rebuilt_after_restart() {
+  user_dir_set(1, "Alice");
+  user_dir_set(2, "Bob");
+  user_dir_remove(1);
+  TEST_ASSERT_TRUE(user_dir_begin());  // Reboot
+  TEST_ASSERT_EQUAL_UINT16(1, user_dir_count());
+  TEST_ASSERT_FALSE(user_dir_get(1, name, sizeof(name)));
+  TEST_ASSERT_TRUE(user_dir_get(2, name, sizeof(name)));
+  TEST_ASSERT_EQUAL_STRING("Bob", name);
+}
+
+void test_rename_rewrites_in_place() {
+  user_dir_set(3, "Alice");
+  size_t size = table_size();
+  TEST_ASSERT_EQUAL_UINT32(HEADER_SIZE + RECORD_SIZE, size);
+  user_dir_set(3, "Alicia");
+  TEST_ASSERT_EQUAL_UINT32(size, table_size());
+  user_dir_get(3, name, sizeof(name));
+  TEST_ASSERT_EQUAL_STRING("Alicia", name);
+}
+
+void test_removed_record_is_reused() {
+  user_dir_set(1, "Alice");
+  user_dir_set(2, "Bob");
+  user_dir_remove(1);
+  user_dir_set(7, "Carol");
+  TEST_ASSERT_EQUAL_UINT32(HEADER_SIZE + 2 * RECORD_SIZE, table_size());
+  TEST_ASSERT_TRUE(user_dir_get(7, name, sizeof(name)));
+  TEST_ASSERT_EQUAL_STRING("Carol", name);
+}
+
+void test_empty_name_removes() {
+  user_dir_set(4, "Alice");
+  TEST_ASSERT_TRUE(user_dir_set(4, ""));
+  TEST_ASSERT_FALSE(user_dir_get(4, name, sizeof(name)));
+  TEST_ASSERT_EQUAL_UINT16(0, user_dir_count());
+}
+
+void test_long_name_truncated() {
+  user_dir_set(8, "A name that is far too long for a record");
+  TEST_ASSERT_TRUE(user_dir_get(8, name, sizeof(name)));
+  TEST_ASSERT_EQUAL_UINT32(USER_NAME_MAX, strlen(name));
+  char small[4];
+  TEST_ASSERT_TRUE(user_dir_get(8, small, sizeof(small)));
+  TEST_ASSERT_EQUAL_STRING("A n", small);
+}
+
+void test_id_out_of_range() {
+  TEST_ASSERT_FALSE(user_dir_set(USER_DIR_MAX_IDS, "Alice"));
+}
+
+void test_truncated_tail_ignored() {
+  user_dir_set(1, "Alice");
+  File f = SPIFFS.open(USER_DIR_PATH, "a");
+  const uint8_t partial[5] = {2, 0, 'B', 'o', 'b'};  // Power lost in the middle of a record
+  f.write(partial, sizeof(partial));
+  f.close();
+  TEST_ASSERT_TRUE(user_dir_begin());
+  TEST_ASSERT_EQUAL_UINT16(1, user_dir_count());
+  TEST_ASSERT_FALSE(user_dir_get(2, name, sizeof(name)));
+  TEST_ASSERT_TRUE(user_dir_set(2, "Bob"));  // Overwrites the partial record
+  TEST_ASSERT_TRUE(user_dir_get(2, name, sizeof(name)));
+  TEST_ASSERT_EQUAL_STRING("Bob", name);
+}
+
+void test_unknown_layout_replaced() {
+  File f = SPIFFS.open(USER_DIR_PATH, "w");
+  f.write((const uint8_t *)"something else", 14);
+  f.close();
+  TEST_ASSERT_TRUE(user_dir_begin());
+  TEST_ASSERT_EQUAL_UINT16(0, user_dir_count());
+  TEST_ASSERT_TRUE(SPIFFS.exists(USER_DIR_PATH ".old"));
+  TEST_ASSERT_TRUE(user_dir_set(1, "Alice"));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_set_and_get);
+  RUN_TEST(test_index_rebuilt_after_restart);
+  RUN_TEST(test_rename_rewrites_in_place);
+  RUN_TEST(test_removed_record_is_reused);
+  RUN_TEST(test_empty_name_removes);
+  RUN_TEST(test_long_name_truncated);
+  RUN_TEST(test_id_out_of_range);
+  RUN_TEST(test_truncated_tail_ignored);
+  RUN_TEST(test_unknown_layout_replaced);
+  return UNITY_END();
+}
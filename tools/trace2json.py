@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""Convert a trace dump (send 't' on the serial monitor of a TRACE_ENABLED build) to Chrome trace JSON.
+
+    pio device monitor | tee monitor.log      # press t, then Ctrl+C
+    python3 tools/trace2json.py monitor.log > trace.json
+
+Open trace.json in https://ui.perfetto.dev or chrome://tracing. Each core is one track; display flushes get a
+track of their own because a stripe ends when its DMA transfer completes, outside the LVGL call that started it.
+Only the last dump in the input is converted. Lines of other output mixed into the dump are skipped.
+"""
+
+import json
+import sys
+
+FLUSH_TRACK = 100  # Track id of the display flushes
+HALF_RANGE = 1 << 31  # A backward step larger than this is a wrap of the 32-bit counter, not reordering
+
+
+def parse(lines):
+    """Return (event names, records) of the last dump in lines."""
+    names, records, inside = {}, [], False
+    for line in lines:
+        fields = line.split()
+        if fields[:3] == ["#", "trace", "begin"]:
+            names, records, inside = {}, [], True
+        elif fields[:3] == ["#", "trace", "end"]:
+            inside = False
+        elif not inside:
+            continue
+        elif fields[:2] == ["#", "event"] and len(fields) >= 4:
+            names[int(fields[2])] = " ".join(fields[3:])
+        elif len(fields) == 5 and fields[2] in ("B", "E", "I"):
+            try:
+                us, event, core, arg = int(fields[0]), int(fields[1]), int(fields[3]), int(fields[4])
+            except ValueError:
+                continue
+            records.append((us, event, fields[2], core, arg))
+    return names, records
+
+
+def convert(names, records):
+    """Chrome trace events for the records, timestamps unwrapped, sorted and relative to the earliest one.
+
+    Records of the two cores can be a few microseconds out of order in the ring; only a backward jump of more
+    than half the counter range is a wrap. Sorting afterwards puts the racing records back in time order.
+    """
+    unwrapped, last, offset = [], None, 0
+    for us, event, phase, core, arg in records:
+        if last is not None and last - us > HALF_RANGE:  # 32-bit microsecond counter wrapped
+            offset += 1 << 32
+        elif last is not None and us - last > HALF_RANGE:  # Raced record from just before a wrap
+            unwrapped.append((us + offset - (1 << 32), event, phase, core, arg))
+            continue
+        last = us
+        unwrapped.append((us + offset, event, phase, core, arg))
+    unwrapped.sort(key=lambda r: r[0])  # Stable: records with equal times keep their ring order
+
+    events, tracks = [], set()
+    base = unwrapped[0][0]
+    for ts, event, phase, core, arg in unwrapped:
+        name = names.get(event, "event %d" % event)
+        tid = FLUSH_TRACK if name == "flush" else core
+        tracks.add((tid, core))
+        e = {"name": name, "ph": phase, "ts": ts - base, "pid": 1, "tid": tid, "args": {"arg": arg}}
+        if phase == "I":
+            e["s"] = "t"  # Instant on its own track
+        events.append(e)
+    for tid, core in sorted(tracks):
+        label = "display flush" if tid == FLUSH_TRACK else "core %d" % core
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": label}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    source = open(sys.argv[1], errors="replace") if len(sys.argv) > 1 else sys.stdin
+    names, records = parse(source)
+    if not records:
+        sys.exit("no trace dump found")
+    json.dump(convert(names, records), sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()